@@ -1,10 +1,11 @@
 #include "board.hpp"
+#include "drivers/interrupt.hpp"
 
+#if !SIMULATION_BUILD
 #include <util/delay_basic.h>
+#endif
 #include <stdio.h>
 
-#include <algorithm>
-
 extern "C" void _putchar(char character) {
     board::EDBG_VCOM.put(character);
 }
@@ -20,7 +21,20 @@ extern "C" void _putchar(char character) {
 //
 //FILE EDBG_STREAM{ .flags = _FDEV_SETUP_WRITE, .put = EDBG_putchar, .get = EDBG_getchar, .udata = 0, };
 
+XMEGA_ISR(TCF0_CCA, board::Timebase_t::handle_compare)
+XMEGA_ISR(TCF1_CCA, board::Timebase_t::handle_compare)
+
 bool board::init() noexcept {
+    constexpr drivers::CLK_Basic clk(device::CLK);
+    constexpr drivers::OSC_Basic osc(device::OSC);
+    constexpr drivers::DFLL_Basic dfll(device::DFLLRC32M);
+    static_assert(CrystalFreq == drivers::CLK::RC32K_HZ, "The DFLL reference must be a 32.768 kHz crystal");
+    if(!drivers::CLK::start_rc32m_dfll<SystemClock>(clk, osc, dfll)) {
+        return false;
+    }
+    timebase.start<SystemClock::per_hz>();
+    drivers::PMIC_Basic(device::PMIC).enable();
+
     SerialC0.init<CPUFreq, 9600, true>();
     SerialC0.start();
     EDBG_VCOM.init<CPUFreq, 9600, true>();
@@ -37,48 +51,35 @@ bool board::init() noexcept {
     return true;
 }
 
-extern void __builtin_avr_delay_cycles(unsigned long);
-
-template<uint16_t MS>
-void delay_ms() noexcept {
-    constexpr uint32_t ticks = ((board::CPUFreq) / 1'000UL) * MS;
-    __builtin_avr_delay_cycles(ticks);
-}
-
-template<uint16_t US>
-void delay_us() noexcept {
-    constexpr uint32_t ticks = ((board::CPUFreq) / 1'000'000UL) * US;
-    __builtin_avr_delay_cycles(ticks);
-}
-
-void board::delay_ms(uint16_t ms) noexcept {
-    const uint32_t tmp = std::max(((board::CPUFreq) / 4'000UL) * ms, 1UL);
-
-    if (tmp > 65535) {
-        //	ticks = requested delay in 1/10 ms
-        auto ticks = static_cast<uint16_t>(ms * 10UL);
-        while (ticks) {
-            // wait 1/10 ms
-            _delay_loop_2(((board::CPUFreq) / 4'000UL) / 10UL);
-            --ticks;
+namespace {
+    /**
+     * Count CPU cycles for the delays while the timebase is not running, before init() or when it failed.
+     * The loop assumes CPUFreq, so on the 2 MHz reset clock it waits longer, which is still AT LEAST.
+     * A simulation has no CPU clock to count, so it doesn't wait.
+     */
+    void spin_us(uint32_t us) noexcept {
+#if !SIMULATION_BUILD
+        constexpr uint16_t loops_per_us = board::CPUFreq / 4'000'000UL;    // _delay_loop_2 takes 4 cycles a loop
+        static_assert(loops_per_us > 0, "The CPU clock is too slow for microsecond delays");
+        constexpr uint16_t max_us = UINT16_MAX / loops_per_us;
+        while(us > 0) {
+            const auto step = static_cast<uint16_t>((us < max_us) ? us : max_us);
+            _delay_loop_2(step * loops_per_us);
+            us -= step;
         }
-    } else {
-        auto ticks = static_cast<uint16_t>(tmp);
-        _delay_loop_2(ticks);
+#else
+        static_cast<void>(us);
+#endif
     }
+}   // namespace
+
+void board::delay_ms(uint16_t ms) noexcept {
+    const auto us = static_cast<drivers::TIMEBASE::micros>(ms) * 1'000UL;
+    if(simulation || !timebase.running()) { spin_us(us); }
+    else { timebase.sleep_for(us); }
 }
 
 void board::delay_us(uint16_t us) noexcept {
-    const uint32_t tmp = std::max(((board::CPUFreq) / 3'000'000UL) * us, 1UL);
-    const uint32_t tmp2 = std::max(((board::CPUFreq) / 4'000'000UL) * us, 1UL);
-
-    if (tmp2 > 65535) {
-        board::delay_ms(us / 1000);
-    } else if (tmp > 255) {
-        auto ticks = static_cast<uint16_t>(tmp2);
-        _delay_loop_2(ticks);
-    } else {
-        auto ticks = static_cast<uint8_t>(tmp);
-        _delay_loop_1(ticks);
-    }
+    if(simulation || !timebase.running()) { spin_us(us); }
+    else { timebase.sleep_for(us); }
 }
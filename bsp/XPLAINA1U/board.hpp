@@ -4,11 +4,16 @@
 #include "drivers/twi.hpp"
 #include "drivers/pin_types.hpp"
 #include "drivers/adc.hpp"
+#include "drivers/clk.hpp"
+#include "drivers/timebase.hpp"
 
 namespace board {
 
 	inline constexpr uint32_t CrystalFreq = 32'768;			//< crystal frequency in Hz
-    inline constexpr uint32_t CPUFreq = 2'000'000;          //< CPU frequency
+    using SystemClock = drivers::CLK::RC32M_32MHZ;          //< clock tree set up by init()
+    inline constexpr uint32_t CPUFreq = SystemClock::cpu_hz; //< CPU frequency
+    /// low power step for drivers::FrequencyScaler, the same source divided down to 2 MHz
+    using IdleClock = drivers::CLK::tree<drivers::CLK::SYSTEM_SOURCE::RC32M, drivers::CLK::RC32M_HZ, drivers::CLK::PRESCALE_A::_16>;
     inline constexpr bool simulation  = SIMULATION_BUILD;   //< true if this is a simulation build
 
     inline constexpr drivers::Uart_Basic SerialC0(device::USARTC0, device::PC2, device::PC3);
@@ -18,6 +23,10 @@ namespace board {
 
     inline constexpr drivers::ADC_SingleEnded_Basic ADC(device::ADCA);
 
+    /// microsecond time on TCF0/TCF1, started by init()
+    using Timebase_t = drivers::Timebase<decltype(device::TCF0), decltype(device::TCF1), decltype(device::EVSYS), decltype(device::SLEEP)>;
+    inline constexpr Timebase_t timebase(device::TCF0, device::TCF1, device::EVSYS, device::SLEEP);
+
     /**
      * Initialize the board.
      * When this function returns the system clocks should be initialized,
@@ -26,9 +35,9 @@ namespace board {
      */
     bool init() noexcept;
 
-    /// delay AT MOST us microseconds
+    /// delay AT LEAST us microseconds, sleeping if interrupts are enabled. Counts cycles until init() started the timebase.
     void delay_us(uint16_t us) noexcept;
-    /// delay AT MOST ms milliseconds
+    /// delay AT LEAST ms milliseconds, sleeping if interrupts are enabled. Counts cycles until init() started the timebase.
     void delay_ms(uint16_t ms) noexcept;
 
 }   // namespace board
@@ -36,6 +36,7 @@
 #include "VPORT.hpp"
 #include "WDT.hpp"
 #include "XOCD.hpp"
+#include "vectors.hpp"
 #include "pin_types.hpp"
 
 namespace device {
@@ -46,10 +47,14 @@ namespace device {
     inline constexpr memory_section app_section{ 0x000000, 0x40000 };
     inline constexpr memory_section apptable_section{ 0x03E000, 0x002000 };
     inline constexpr memory_section boot_section{ 0x040000, 0x002000 };
+    inline constexpr uint16_t flash_page_size = 512;
     // data memory addresses
     inline constexpr memory_section io_section{ 0x0000, 0x1000 };
     inline constexpr memory_section eeprom_section{ 0x1000, 0x1000 };
     inline constexpr memory_section sram_section{ 0x2000, 0x4000 };
+    inline constexpr uint16_t eeprom_page_size = 32;
+    // signature rows
+    inline constexpr memory_section user_signature_section{ 0x0000, 0x0200 };
 
     /********** Peripheral Instances. Mapped to memory. **********/
     inline constexpr sfr::GPIO_t< 0x0000 > GPIO = {};       //  General Purpose IO Registers
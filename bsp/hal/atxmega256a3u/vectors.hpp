@@ -0,0 +1,165 @@
+/**
+ * ATxmega256A3U interrupt vectors
+ * Vector numbers of the peripheral instances, for binding handlers with XMEGA_ISR() (see drivers/interrupt.hpp)
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace device {
+namespace vectors {
+    /// number of vectors, including the reset vector
+    inline constexpr uint8_t count = 127;
+
+    /**
+     * First interrupt vector of a peripheral instance, by its base address. 0 if the instance has no interrupts.
+     * The other vectors of the instance follow in the order of its interrupt sources.
+     */
+    constexpr uint8_t first(const uint16_t address) noexcept {
+        switch(address) {
+            case 0x0050: return   1;   // OSC
+            case 0x00C0: return  31;   // AES
+            case 0x0100: return   6;   // DMA
+            case 0x01C0: return  32;   // NVM
+            case 0x0200: return  71;   // ADCA
+            case 0x0240: return  39;   // ADCB
+            case 0x0380: return  68;   // ACA
+            case 0x0390: return  36;   // ACB
+            case 0x0400: return  10;   // RTC
+            case 0x0480: return  12;   // TWIC
+            case 0x04A0: return  45;   // TWIE
+            case 0x04C0: return 125;   // USB
+            case 0x0600: return  66;   // PORTA
+            case 0x0620: return  34;   // PORTB
+            case 0x0640: return   2;   // PORTC
+            case 0x0660: return  64;   // PORTD
+            case 0x0680: return  43;   // PORTE
+            case 0x06A0: return 104;   // PORTF
+            case 0x07E0: return   4;   // PORTR
+            case 0x0800: return  14;   // TCC0
+            case 0x0840: return  20;   // TCC1
+            case 0x08A0: return  25;   // USARTC0
+            case 0x08B0: return  28;   // USARTC1
+            case 0x08C0: return  24;   // SPIC
+            case 0x0900: return  77;   // TCD0
+            case 0x0940: return  83;   // TCD1
+            case 0x09A0: return  88;   // USARTD0
+            case 0x09B0: return  91;   // USARTD1
+            case 0x09C0: return  87;   // SPID
+            case 0x0A00: return  47;   // TCE0
+            case 0x0A40: return  53;   // TCE1
+            case 0x0AA0: return  58;   // USARTE0
+            case 0x0AB0: return  61;   // USARTE1
+            case 0x0AC0: return  57;   // SPIE
+            case 0x0B00: return 108;   // TCF0
+            case 0x0BA0: return 119;   // USARTF0
+            default: return 0;
+        }
+    }
+}   // namespace vectors
+}   // namespace device
+
+#define XMEGA_VECTOR_OSC_OSCF            1
+#define XMEGA_VECTOR_PORTC_INT0          2
+#define XMEGA_VECTOR_PORTC_INT1          3
+#define XMEGA_VECTOR_PORTR_INT0          4
+#define XMEGA_VECTOR_PORTR_INT1          5
+#define XMEGA_VECTOR_DMA_CH0             6
+#define XMEGA_VECTOR_DMA_CH1             7
+#define XMEGA_VECTOR_DMA_CH2             8
+#define XMEGA_VECTOR_DMA_CH3             9
+#define XMEGA_VECTOR_RTC_OVF             10
+#define XMEGA_VECTOR_RTC_COMP            11
+#define XMEGA_VECTOR_TWIC_TWIS           12
+#define XMEGA_VECTOR_TWIC_TWIM           13
+#define XMEGA_VECTOR_TCC0_OVF            14
+#define XMEGA_VECTOR_TCC0_ERR            15
+#define XMEGA_VECTOR_TCC0_CCA            16
+#define XMEGA_VECTOR_TCC0_CCB            17
+#define XMEGA_VECTOR_TCC0_CCC            18
+#define XMEGA_VECTOR_TCC0_CCD            19
+#define XMEGA_VECTOR_TCC1_OVF            20
+#define XMEGA_VECTOR_TCC1_ERR            21
+#define XMEGA_VECTOR_TCC1_CCA            22
+#define XMEGA_VECTOR_TCC1_CCB            23
+#define XMEGA_VECTOR_SPIC_INT            24
+#define XMEGA_VECTOR_USARTC0_RXC         25
+#define XMEGA_VECTOR_USARTC0_DRE         26
+#define XMEGA_VECTOR_USARTC0_TXC         27
+#define XMEGA_VECTOR_USARTC1_RXC         28
+#define XMEGA_VECTOR_USARTC1_DRE         29
+#define XMEGA_VECTOR_USARTC1_TXC         30
+#define XMEGA_VECTOR_AES_INT             31
+#define XMEGA_VECTOR_NVM_EE              32
+#define XMEGA_VECTOR_NVM_SPM             33
+#define XMEGA_VECTOR_PORTB_INT0          34
+#define XMEGA_VECTOR_PORTB_INT1          35
+#define XMEGA_VECTOR_ACB_AC0             36
+#define XMEGA_VECTOR_ACB_AC1             37
+#define XMEGA_VECTOR_ACB_ACW             38
+#define XMEGA_VECTOR_ADCB_CH0            39
+#define XMEGA_VECTOR_ADCB_CH1            40
+#define XMEGA_VECTOR_ADCB_CH2            41
+#define XMEGA_VECTOR_ADCB_CH3            42
+#define XMEGA_VECTOR_PORTE_INT0          43
+#define XMEGA_VECTOR_PORTE_INT1          44
+#define XMEGA_VECTOR_TWIE_TWIS           45
+#define XMEGA_VECTOR_TWIE_TWIM           46
+#define XMEGA_VECTOR_TCE0_OVF            47
+#define XMEGA_VECTOR_TCE0_ERR            48
+#define XMEGA_VECTOR_TCE0_CCA            49
+#define XMEGA_VECTOR_TCE0_CCB            50
+#define XMEGA_VECTOR_TCE0_CCC            51
+#define XMEGA_VECTOR_TCE0_CCD            52
+#define XMEGA_VECTOR_TCE1_OVF            53
+#define XMEGA_VECTOR_TCE1_ERR            54
+#define XMEGA_VECTOR_TCE1_CCA            55
+#define XMEGA_VECTOR_TCE1_CCB            56
+#define XMEGA_VECTOR_SPIE_INT            57
+#define XMEGA_VECTOR_USARTE0_RXC         58
+#define XMEGA_VECTOR_USARTE0_DRE         59
+#define XMEGA_VECTOR_USARTE0_TXC         60
+#define XMEGA_VECTOR_USARTE1_RXC         61
+#define XMEGA_VECTOR_USARTE1_DRE         62
+#define XMEGA_VECTOR_USARTE1_TXC         63
+#define XMEGA_VECTOR_PORTD_INT0          64
+#define XMEGA_VECTOR_PORTD_INT1          65
+#define XMEGA_VECTOR_PORTA_INT0          66
+#define XMEGA_VECTOR_PORTA_INT1          67
+#define XMEGA_VECTOR_ACA_AC0             68
+#define XMEGA_VECTOR_ACA_AC1             69
+#define XMEGA_VECTOR_ACA_ACW             70
+#define XMEGA_VECTOR_ADCA_CH0            71
+#define XMEGA_VECTOR_ADCA_CH1            72
+#define XMEGA_VECTOR_ADCA_CH2            73
+#define XMEGA_VECTOR_ADCA_CH3            74
+#define XMEGA_VECTOR_TCD0_OVF            77
+#define XMEGA_VECTOR_TCD0_ERR            78
+#define XMEGA_VECTOR_TCD0_CCA            79
+#define XMEGA_VECTOR_TCD0_CCB            80
+#define XMEGA_VECTOR_TCD0_CCC            81
+#define XMEGA_VECTOR_TCD0_CCD            82
+#define XMEGA_VECTOR_TCD1_OVF            83
+#define XMEGA_VECTOR_TCD1_ERR            84
+#define XMEGA_VECTOR_TCD1_CCA            85
+#define XMEGA_VECTOR_TCD1_CCB            86
+#define XMEGA_VECTOR_SPID_INT            87
+#define XMEGA_VECTOR_USARTD0_RXC         88
+#define XMEGA_VECTOR_USARTD0_DRE         89
+#define XMEGA_VECTOR_USARTD0_TXC         90
+#define XMEGA_VECTOR_USARTD1_RXC         91
+#define XMEGA_VECTOR_USARTD1_DRE         92
+#define XMEGA_VECTOR_USARTD1_TXC         93
+#define XMEGA_VECTOR_PORTF_INT0          104
+#define XMEGA_VECTOR_PORTF_INT1          105
+#define XMEGA_VECTOR_TCF0_OVF            108
+#define XMEGA_VECTOR_TCF0_ERR            109
+#define XMEGA_VECTOR_TCF0_CCA            110
+#define XMEGA_VECTOR_TCF0_CCB            111
+#define XMEGA_VECTOR_TCF0_CCC            112
+#define XMEGA_VECTOR_TCF0_CCD            113
+#define XMEGA_VECTOR_USARTF0_RXC         119
+#define XMEGA_VECTOR_USARTF0_DRE         120
+#define XMEGA_VECTOR_USARTF0_TXC         121
+#define XMEGA_VECTOR_USB_BUSEVENT        125
+#define XMEGA_VECTOR_USB_TRNCOMPL        126
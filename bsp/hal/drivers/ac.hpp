@@ -0,0 +1,194 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"           // need this to forward the enum definitions
+#include "drivers/evsys.hpp"    // comparator event sources
+#include <cstdint>
+
+namespace drivers {
+
+    namespace AC {
+        using INTERRUPT_MODE = sfr::AC::INTMODEv;
+        using INTERRUPT_LVL = sfr::AC::INTLVLv;
+        using HYSTERESIS = sfr::AC::HYSMODEv;
+        using INPUT_POS = sfr::AC::MUXPOSv;
+        using INPUT_NEG = sfr::AC::MUXNEGv;
+        using WINDOW_MODE = sfr::AC::WINTMODEv;
+        using WINDOW_LVL = sfr::AC::WINTLVLv;
+        using WINDOW_STATE = sfr::AC::WSTATEv;
+
+        /**
+         * Voltage scaler setting for a threshold as a fraction of VCC, solved at compile time. The scaler
+         * output is VCC * (SCALEFAC + 1) / 64, the nearest step is used.
+         * example: comparator.set_scaler(drivers::AC::scaler<3300, 1200>());
+         */
+        template <uint32_t VccMv, uint32_t ThresholdMv>
+        constexpr uint8_t scaler() noexcept {
+            constexpr uint32_t steps = (ThresholdMv * 64U + VccMv / 2U) / VccMv;
+            static_assert(steps >= 1 && steps <= 64, "Threshold must be between VCC/64 and VCC");
+            return static_cast<uint8_t>(steps - 1U);
+        }
+    }   // namespace AC
+
+    /**
+     * Zero overhead driver for a pair of analog comparators, for example: drivers::AC_Basic comparators(device::ACA);
+     *
+     * Each comparator always generates events on its own event channel source (see event_source()), on the
+     * edges selected by its interrupt mode, whether or not the interrupt is enabled. Routed through the event
+     * system a threshold crossing can capture or restart a timer, trigger the ADC or a DMA transfer, or drive the
+     * AWEX fault input, with no CPU latency. The comparator interrupts also wake the CPU from the idle, power
+     * save and power down sleep modes, so a threshold can be watched with the CPU asleep.
+     *
+     * In window mode both comparators share the signal on their positive inputs: comparator 0's negative input
+     * is the upper limit and comparator 1's is the lower limit.
+     */
+    template <typename AC_INSTANCE>
+    class AC_Basic {
+        AC_INSTANCE m_instance;
+//        decltype(device::ACA) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        /// ACA events start at 0x10, ACB at 0x13: channel 0, channel 1 and the window
+        static constexpr uint8_t EVENT_BASE = 0x10U + ((AC_INSTANCE::BaseAddress - 0x380U) >> 4U) * 3U;
+
+    public:
+        /// event system source of a comparator output
+        template <uint8_t CH>
+        static constexpr EVSYS::SOURCE event_source() noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            return static_cast<EVSYS::SOURCE>(EVENT_BASE + CH);
+        }
+
+        /// event system source of the window state
+        static constexpr EVSYS::SOURCE window_event_source() noexcept {
+            return static_cast<EVSYS::SOURCE>(EVENT_BASE + 2U);
+        }
+
+        constexpr AC_Basic(const AC_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /**
+         * Select the inputs and enable a comparator. The output is valid after the comparator start up time.
+         * @param high_speed [IN] shorter propagation delay at a higher current
+         */
+        template <uint8_t CH>
+        constexpr void start(const AC::INPUT_POS positive, const AC::INPUT_NEG negative,
+                             const AC::HYSTERESIS hysteresis = AC::HYSTERESIS::SMALL, const bool high_speed = false) const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            if constexpr (CH == 0) {
+                m_instance.AC0MUXCTRL = m_instance.AC0MUXCTRL.MUXPOS.shift(positive) | m_instance.AC0MUXCTRL.MUXNEG.shift(negative);
+                m_instance.AC0CTRL = (m_instance.AC0CTRL.read() & 0xF0U) | static_cast<uint8_t>(
+                                     m_instance.AC0CTRL.HSMODE.shift(high_speed).value
+                                   | m_instance.AC0CTRL.HYSMODE.shift(hysteresis).value
+                                   | m_instance.AC0CTRL.ENABLE.shift(true).value);
+            }
+            else {
+                m_instance.AC1MUXCTRL = m_instance.AC1MUXCTRL.MUXPOS.shift(positive) | m_instance.AC1MUXCTRL.MUXNEG.shift(negative);
+                m_instance.AC1CTRL = (m_instance.AC1CTRL.read() & 0xF0U) | static_cast<uint8_t>(
+                                     m_instance.AC1CTRL.HSMODE.shift(high_speed).value
+                                   | m_instance.AC1CTRL.HYSMODE.shift(hysteresis).value
+                                   | m_instance.AC1CTRL.ENABLE.shift(true).value);
+            }
+        }
+
+        template <uint8_t CH>
+        constexpr void stop() const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            if constexpr (CH == 0) { m_instance.AC0CTRL.ENABLE = false; }
+            else { m_instance.AC1CTRL.ENABLE = false; }
+        }
+
+        /// select the output edges that set the interrupt flag and generate events, and the interrupt level
+        template <uint8_t CH>
+        constexpr void set_interrupt(const AC::INTERRUPT_MODE mode, const AC::INTERRUPT_LVL lvl = AC::INTERRUPT_LVL::OFF) const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            if constexpr (CH == 0) {
+                m_instance.AC0CTRL = (m_instance.AC0CTRL.read() & 0x0FU) | static_cast<uint8_t>(
+                                     m_instance.AC0CTRL.INTMODE.shift(mode).value | m_instance.AC0CTRL.INTLVL.shift(lvl).value);
+            }
+            else {
+                m_instance.AC1CTRL = (m_instance.AC1CTRL.read() & 0x0FU) | static_cast<uint8_t>(
+                                     m_instance.AC1CTRL.INTMODE.shift(mode).value | m_instance.AC1CTRL.INTLVL.shift(lvl).value);
+            }
+        }
+
+        /// set the internal VCC scaler, used with AC::INPUT_NEG::SCALER. See AC::scaler().
+        constexpr void set_scaler(const uint8_t factor) const noexcept {
+            m_instance.CTRLB = static_cast<uint8_t>(factor & 0x3FU);
+        }
+
+        /// drive the comparator output on pin 7 (comparator 0) or pin 6 (comparator 1) of the port
+        template <uint8_t CH>
+        constexpr void enable_pin_output(const bool enable = true) const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            if constexpr (CH == 0) { m_instance.CTRLA.AC0OUT = enable; }
+            else { m_instance.CTRLA.AC1OUT = enable; }
+        }
+
+        /// true while the positive input is above the negative input
+        template <uint8_t CH>
+        [[nodiscard]] constexpr bool output() const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            constexpr uint8_t mask = CH == 0 ? m_instance.STATUS.AC0STATE.mask : m_instance.STATUS.AC1STATE.mask;
+            return m_instance.STATUS.read() & mask;
+        }
+
+        /// true if the selected edge occurred since the last call. Clears the flag.
+        template <uint8_t CH>
+        [[nodiscard]] constexpr bool triggered() const noexcept {
+            static_assert(CH < 2, "There are two comparators, 0 and 1");
+            constexpr uint8_t mask = CH == 0 ? m_instance.STATUS.AC0IF.mask : m_instance.STATUS.AC1IF.mask;
+            if(m_instance.STATUS.read() & mask) {
+                m_instance.STATUS = mask;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Compare a signal against a window and enable window mode.
+         * @param signal [IN] the input watched by both comparators
+         * @param upper [IN] upper limit, the negative input of comparator 0
+         * @param lower [IN] lower limit, the negative input of comparator 1
+         * @param mode [IN] window condition that sets the flag and requests the interrupt
+         */
+        constexpr void start_window(const AC::INPUT_POS signal, const AC::INPUT_NEG upper, const AC::INPUT_NEG lower,
+                                    const AC::WINDOW_MODE mode, const AC::WINDOW_LVL lvl = AC::WINDOW_LVL::OFF,
+                                    const AC::HYSTERESIS hysteresis = AC::HYSTERESIS::SMALL) const noexcept {
+            start<0>(signal, upper, hysteresis);
+            start<1>(signal, lower, hysteresis);
+            m_instance.WINCTRL = m_instance.WINCTRL.WEN.shift(true)
+                               | m_instance.WINCTRL.WINTMODE.shift(mode)
+                               | m_instance.WINCTRL.WINTLVL.shift(lvl);
+        }
+
+        constexpr void stop_window() const noexcept {
+            m_instance.WINCTRL = 0;
+            stop<0>();
+            stop<1>();
+        }
+
+        /// where the signal is relative to the window
+        [[nodiscard]] constexpr AC::WINDOW_STATE window_state() const noexcept {
+            return static_cast<AC::WINDOW_STATE>(m_instance.STATUS.read() >> 6U);
+        }
+
+        /// true if the window condition occurred since the last call. Clears the flag.
+        [[nodiscard]] constexpr bool window_triggered() const noexcept {
+            constexpr uint8_t mask = m_instance.STATUS.WIF.mask;
+            if(m_instance.STATUS.read() & mask) {
+                m_instance.STATUS = mask;
+                return true;
+            }
+            return false;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
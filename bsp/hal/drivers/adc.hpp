@@ -6,6 +6,7 @@
 
 #include "pin_types.hpp"
 #include "device.hpp"
+#include "drivers/power.hpp"    // peripheral clock gating
 #include <cstdint>
 
 namespace drivers {
@@ -26,6 +27,8 @@ namespace drivers {
         using INPUT_NEG = sfr::ADC::CH_MUXNEGv;
         using INTERRUPT_MODE = sfr::ADC::CH_INTMODEv;
         using INTERRUPT_LVL = sfr::ADC::CH_INTLVLv;
+        using EVENT_SELECT = sfr::ADC::EVSELv;
+        using EVENT_ACTION = sfr::ADC::EVACTv;
 
     } // namespace ADC
 
@@ -50,6 +53,7 @@ namespace drivers {
                             const ADC::CURRENT_LIMIT current_limit = ADC::CURRENT_LIMIT::NO,
                             const bool signed_mode = false) const noexcept
         {
+            POWER::enable<ADC_INSTANCE>();
             m_instance.CTRLB = m_instance.CTRLB.IMPMODE.shift(high_impedance)
                              | m_instance.CTRLB.CURRLIMIT.shift(current_limit)
                              | m_instance.CTRLB.CONMODE.shift(signed_mode)
@@ -67,17 +71,19 @@ namespace drivers {
 
         /**
          * Enable the ADC channel. Sets the enable bit and flushes old readings.
-         * If supported this will enable the clock to the ADC.
+         * Also turns on the clock to the ADC, see POWER::enable().
          */
         constexpr void start() const noexcept {
+            POWER::enable<ADC_INSTANCE>();
             m_instance.CTRLA |= (m_instance.CTRLA.ENABLE.shift(1) | m_instance.CTRLA.FLUSH.shift(1));
         }
 
         /**
-         * Disable the ADC channel. Clears the enable bit, and if supported disables clock input.
+         * Disable the ADC channel. Clears the enable bit and stops the clock to the ADC.
          */
         constexpr void stop() const noexcept {
             m_instance.CTRLA.ENABLE = false;
+            POWER::disable<ADC_INSTANCE>();
         }
 
         constexpr void set_reference(const ADC::REFERENCE ref) const noexcept {
@@ -89,6 +95,15 @@ namespace drivers {
             m_instance.CMP = cmp;
         }
 
+        /**
+         * Start conversions from the event system instead of the CPU.
+         * @param select [IN] the first event channel of the group the ADC listens to
+         * @param action [IN] which ADC channels the events of the group start
+         */
+        constexpr void set_event(const ADC::EVENT_SELECT select, const ADC::EVENT_ACTION action = ADC::EVENT_ACTION::CH0) const noexcept {
+            m_instance.EVCTRL = m_instance.EVCTRL.EVSEL.shift(select) | m_instance.EVCTRL.EVACT.shift(action);
+        }
+
         template<unsigned CH = 0>
         constexpr void setup_channel(const ADC::INPUT_MODE mode = ADC::INPUT_MODE::SINGLEENDED, const ADC::GAIN gain = ADC::GAIN::_1X) const noexcept {
             static_assert(CH < 4, "ADC only has channels 0-3!");
@@ -0,0 +1,519 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include "drivers/dma.hpp"  // DMA channels for the DMA fed driver
+#include "nonstd/expected.hpp"     // std::expected implementation for safe return value
+#include "nonstd/span.hpp"         // span for non-owning range based read/write functions
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace drivers {
+
+    // namespace for helper functions, enums, etc that are used across instances.
+    namespace AES {
+        inline constexpr uint8_t BLOCK_SIZE = 16;
+        using block = std::array<uint8_t, BLOCK_SIZE>;
+        using INT_LVL = sfr::AES::INTLVLv;
+
+        /// list of AES errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            TIMEOUT = (1U<<7U),
+            HARDWARE_ERROR = (1U<<6U),
+            BAD_LENGTH = (1U<<5U),
+            BUSY = (1U<<4U),
+            NONE = (1U<<0U)
+        };
+
+        /**
+         * Cached key schedule. The XMEGA AES module expands the key on the fly, so decryption must start
+         * from the last subkey of the expansion instead of the cipher key. Computing the last subkey costs one
+         * full encryption, so it is done once per key and stored here.
+         */
+        struct key_schedule {
+            block encrypt;      //< the cipher key
+            block decrypt;      //< last subkey of the key expansion, loaded for decryption
+        };
+
+        /// increment a big endian counter block (NIST SP 800-38A CTR mode standard incrementing function)
+        constexpr void increment_counter(block& ctr) noexcept {
+            for(uint8_t i = BLOCK_SIZE; i > 0; --i) {
+                if(++ctr[i - 1] != 0) { break; }
+            }
+        }
+
+        /**
+         * Bit exact software model of the AES module, used for the simulation build.
+         * The model follows the hardware: the key schedule is computed on the fly, and decryption runs
+         * the key schedule backwards starting from the last subkey.
+         */
+        namespace software {
+            /// multiply by x in GF(2^8)
+            constexpr uint8_t xtime(const uint8_t a) noexcept {
+                return static_cast<uint8_t>((a << 1U) ^ ((a & 0x80U) ? 0x1BU : 0x00U));
+            }
+
+            /// general multiply in GF(2^8)
+            constexpr uint8_t gmul(uint8_t a, uint8_t b) noexcept {
+                uint8_t p = 0;
+                while(b) {
+                    if(b & 1U) { p ^= a; }
+                    a = xtime(a);
+                    b >>= 1U;
+                }
+                return p;
+            }
+
+            constexpr std::array<uint8_t, 256> make_sbox() noexcept {
+                std::array<uint8_t, 256> sbox{};
+                for(unsigned x = 0; x < 256; ++x) {
+                    // multiplicative inverse is x^254, with 0 mapping to 0
+                    uint8_t inv = x ? 1 : 0;
+                    for(uint8_t i = 0; x && i < 254; ++i) {
+                        inv = gmul(inv, static_cast<uint8_t>(x));
+                    }
+                    uint8_t s = inv;
+                    for(uint8_t i = 1; i < 5; ++i) {
+                        s ^= static_cast<uint8_t>((inv << i) | (inv >> (8U - i)));
+                    }
+                    sbox[x] = s ^ 0x63U;
+                }
+                return sbox;
+            }
+
+            constexpr std::array<uint8_t, 256> make_inv_sbox() noexcept {
+                const auto sbox = make_sbox();
+                std::array<uint8_t, 256> inv{};
+                for(unsigned x = 0; x < 256; ++x) {
+                    inv[sbox[x]] = static_cast<uint8_t>(x);
+                }
+                return inv;
+            }
+
+            inline constexpr std::array<uint8_t, 256> sbox = make_sbox();
+            inline constexpr std::array<uint8_t, 256> inv_sbox = make_inv_sbox();
+            inline constexpr std::array<uint8_t, 10> rcon = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36};
+
+            /// advance the key to the next round key
+            constexpr void next_round_key(block& k, const uint8_t rc) noexcept {
+                k[0] ^= sbox[k[13]] ^ rc;
+                k[1] ^= sbox[k[14]];
+                k[2] ^= sbox[k[15]];
+                k[3] ^= sbox[k[12]];
+                for(uint8_t i = 4; i < BLOCK_SIZE; ++i) {
+                    k[i] ^= k[i - 4];
+                }
+            }
+
+            /// step the key back to the previous round key
+            constexpr void prev_round_key(block& k, const uint8_t rc) noexcept {
+                for(uint8_t i = BLOCK_SIZE - 1; i > 3; --i) {
+                    k[i] ^= k[i - 4];
+                }
+                k[0] ^= sbox[k[13]] ^ rc;
+                k[1] ^= sbox[k[14]];
+                k[2] ^= sbox[k[15]];
+                k[3] ^= sbox[k[12]];
+            }
+
+            constexpr void add_round_key(block& s, const block& k) noexcept {
+                for(uint8_t i = 0; i < BLOCK_SIZE; ++i) { s[i] ^= k[i]; }
+            }
+
+            /// SubBytes and ShiftRows in one pass. Byte i is row i%4 of column i/4.
+            constexpr void sub_shift(block& s) noexcept {
+                const block t = s;
+                for(uint8_t i = 0; i < BLOCK_SIZE; ++i) {
+                    s[i] = sbox[t[(i + 4U * (i & 3U)) & 0x0FU]];
+                }
+            }
+
+            /// InvShiftRows and InvSubBytes in one pass
+            constexpr void inv_sub_shift(block& s) noexcept {
+                const block t = s;
+                for(uint8_t i = 0; i < BLOCK_SIZE; ++i) {
+                    s[(i + 4U * (i & 3U)) & 0x0FU] = inv_sbox[t[i]];
+                }
+            }
+
+            constexpr void mix_columns(block& s) noexcept {
+                for(uint8_t c = 0; c < BLOCK_SIZE; c += 4) {
+                    const uint8_t a0 = s[c], a1 = s[c + 1], a2 = s[c + 2], a3 = s[c + 3];
+                    const uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                    s[c]     ^= all ^ xtime(a0 ^ a1);
+                    s[c + 1] ^= all ^ xtime(a1 ^ a2);
+                    s[c + 2] ^= all ^ xtime(a2 ^ a3);
+                    s[c + 3] ^= all ^ xtime(a3 ^ a0);
+                }
+            }
+
+            constexpr void inv_mix_columns(block& s) noexcept {
+                for(uint8_t c = 0; c < BLOCK_SIZE; c += 4) {
+                    const uint8_t a0 = s[c], a1 = s[c + 1], a2 = s[c + 2], a3 = s[c + 3];
+                    s[c]     = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3, 9);
+                    s[c + 1] = gmul(a0, 9)  ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+                    s[c + 2] = gmul(a0, 13) ^ gmul(a1, 9)  ^ gmul(a2, 14) ^ gmul(a3, 11);
+                    s[c + 3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2, 9)  ^ gmul(a3, 14);
+                }
+            }
+
+            /// encrypt one block in place
+            constexpr void encrypt(block& s, block k) noexcept {
+                add_round_key(s, k);
+                for(uint8_t round = 0; round < 10; ++round) {
+                    sub_shift(s);
+                    if(round != 9) { mix_columns(s); }
+                    next_round_key(k, rcon[round]);
+                    add_round_key(s, k);
+                }
+            }
+
+            /// decrypt one block in place, starting from the last subkey
+            constexpr void decrypt(block& s, block k) noexcept {
+                for(uint8_t round = 10; round > 0; --round) {
+                    add_round_key(s, k);
+                    if(round != 10) { inv_mix_columns(s); }
+                    inv_sub_shift(s);
+                    prev_round_key(k, rcon[round - 1]);
+                }
+                add_round_key(s, k);
+            }
+
+            /// the key register contents after an encryption: the last subkey
+            constexpr block last_subkey(block k) noexcept {
+                for(uint8_t round = 0; round < 10; ++round) {
+                    next_round_key(k, rcon[round]);
+                }
+                return k;
+            }
+        }   // namespace software
+
+    }   // namespace AES
+
+    /**
+     * Single block AES-128 engine with ECB, CBC and CTR modes built around it. The CPU moves every byte
+     * of key and state, see AES_DMA for the DMA fed version. Keys are passed as a cached AES::key_schedule
+     * made with make_key_schedule().
+     *
+     * The key memory holds the last subkey after an encryption, so the key is reloaded for every block.
+     * In a simulation build the module is replaced by a bit exact software model.
+     */
+    template <typename AES_INSTANCE>
+    class AES_Basic {
+        AES_INSTANCE m_instance;
+//        decltype(device::AES) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        static constexpr bool simulation = ucpp::registers::sim::simulation;
+
+        /// busy wait for the state ready flag or an error
+        [[nodiscard]] constexpr nonstd::expected<bool, AES::error> wait() const noexcept {
+            for(uint16_t countdown = 1000; countdown > 0; --countdown) {
+                const uint8_t status = m_instance.STATUS;
+                if(status & m_instance.STATUS.ERROR.mask) {
+                    m_instance.STATUS.ERROR = true;
+                    return nonstd::make_unexpected(AES::error::HARDWARE_ERROR);
+                }
+                if(status & m_instance.STATUS.SRIF.mask) {
+                    return true;
+                }
+            }
+            return nonstd::make_unexpected(AES::error::TIMEOUT);
+        }
+
+        /// runs one block through the module in place. Input is XORed with pre before it is written,
+        /// and the output is XORed with post after it is read. This is how the chaining modes are built.
+        [[nodiscard]] constexpr nonstd::expected<bool, AES::error>
+        process(const AES::block& key, uint8_t* data, const bool decrypt, const uint8_t* pre = nullptr, const uint8_t* post = nullptr) const noexcept {
+            if constexpr (simulation) {
+                AES::block s{};
+                for(uint8_t i = 0; i < AES::BLOCK_SIZE; ++i) { s[i] = pre ? data[i] ^ pre[i] : data[i]; }
+                if(decrypt) { AES::software::decrypt(s, key); }
+                else        { AES::software::encrypt(s, key); }
+                for(uint8_t i = 0; i < AES::BLOCK_SIZE; ++i) { data[i] = post ? s[i] ^ post[i] : s[i]; }
+                return true;
+            }
+            else {
+                load_key(key);
+                for(uint8_t i = 0; i < AES::BLOCK_SIZE; ++i) {
+                    m_instance.STATE = pre ? data[i] ^ pre[i] : data[i];
+                }
+                m_instance.CTRL = m_instance.CTRL.START.shift(true) | m_instance.CTRL.DECRYPT.shift(decrypt);
+                const auto r = wait();
+                if(!r) { return r; }
+                for(uint8_t i = 0; i < AES::BLOCK_SIZE; ++i) {
+                    const uint8_t s = m_instance.STATE;
+                    data[i] = post ? s ^ post[i] : s;
+                }
+                return true;
+            }
+        }
+
+    public:
+        constexpr AES_Basic(const AES_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// resets the module, clearing the key, state and control registers
+        constexpr void reset() const noexcept {
+            m_instance.CTRL = m_instance.CTRL.RESET.shift(true);
+        }
+
+        /// sets the state ready interrupt level
+        constexpr void enable_interrupt(const AES::INT_LVL lvl) const noexcept {
+            m_instance.INTCTRL = m_instance.INTCTRL.INTLVL.shift(lvl);
+        }
+
+        /// writes a key, or last subkey, to the key memory
+        constexpr void load_key(const AES::block& key) const noexcept {
+            for(const uint8_t& k : key) {
+                m_instance.KEY = k;
+            }
+        }
+
+        /**
+         * Build the cached key schedule for a key. On hardware this runs one dummy encryption and reads the
+         * last subkey back out of the key memory. This costs one block, so do it once per key, not per message.
+         */
+        [[nodiscard]] constexpr nonstd::expected<AES::key_schedule, AES::error> make_key_schedule(const AES::block& key) const noexcept {
+            if constexpr (simulation) {
+                return AES::key_schedule{key, AES::software::last_subkey(key)};
+            }
+            else {
+                AES::key_schedule ks{key, {}};
+                AES::block dummy{};
+                const auto r = process(key, dummy.data(), false);
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+                for(uint8_t& k : ks.decrypt) {
+                    k = m_instance.KEY;
+                }
+                return ks;
+            }
+        }
+
+        /// encrypt a single block in place
+        [[nodiscard]] constexpr nonstd::expected<uint16_t, AES::error> encrypt(const AES::key_schedule& ks, AES::block& data) const noexcept {
+            const auto r = process(ks.encrypt, data.data(), false);
+            if(!r) { return nonstd::make_unexpected(r.error()); }
+            return AES::BLOCK_SIZE;
+        }
+
+        /// decrypt a single block in place
+        [[nodiscard]] constexpr nonstd::expected<uint16_t, AES::error> decrypt(const AES::key_schedule& ks, AES::block& data) const noexcept {
+            const auto r = process(ks.decrypt, data.data(), true);
+            if(!r) { return nonstd::make_unexpected(r.error()); }
+            return AES::BLOCK_SIZE;
+        }
+
+        /// ECB encrypt in place. Length must be a multiple of the block size.
+        [[nodiscard]] constexpr nonstd::expected<size_t, AES::error>
+        ecb_encrypt(const AES::key_schedule& ks, nonstd::span<uint8_t> data) const noexcept {
+            if(data.size() % AES::BLOCK_SIZE) { return nonstd::make_unexpected(AES::error::BAD_LENGTH); }
+            for(size_t i = 0; i < data.size(); i += AES::BLOCK_SIZE) {
+                const auto r = process(ks.encrypt, &data[i], false);
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+            }
+            return data.size();
+        }
+
+        /// ECB decrypt in place. Length must be a multiple of the block size.
+        [[nodiscard]] constexpr nonstd::expected<size_t, AES::error>
+        ecb_decrypt(const AES::key_schedule& ks, nonstd::span<uint8_t> data) const noexcept {
+            if(data.size() % AES::BLOCK_SIZE) { return nonstd::make_unexpected(AES::error::BAD_LENGTH); }
+            for(size_t i = 0; i < data.size(); i += AES::BLOCK_SIZE) {
+                const auto r = process(ks.decrypt, &data[i], true);
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+            }
+            return data.size();
+        }
+
+        /**
+         * CBC encrypt in place. Length must be a multiple of the block size.
+         * @param iv [IN/OUT] initialization vector, updated to the last ciphertext block so a message can be
+         *                    encrypted in several calls.
+         */
+        [[nodiscard]] constexpr nonstd::expected<size_t, AES::error>
+        cbc_encrypt(const AES::key_schedule& ks, AES::block& iv, nonstd::span<uint8_t> data) const noexcept {
+            if(data.size() % AES::BLOCK_SIZE) { return nonstd::make_unexpected(AES::error::BAD_LENGTH); }
+            const uint8_t* chain = iv.data();
+            for(size_t i = 0; i < data.size(); i += AES::BLOCK_SIZE) {
+                const auto r = process(ks.encrypt, &data[i], false, chain);
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+                chain = &data[i];
+            }
+            std::copy(chain, chain + AES::BLOCK_SIZE, iv.begin());
+            return data.size();
+        }
+
+        /**
+         * CBC decrypt in place. Length must be a multiple of the block size.
+         * @param iv [IN/OUT] initialization vector, updated to the last ciphertext block so a message can be
+         *                    decrypted in several calls.
+         */
+        [[nodiscard]] constexpr nonstd::expected<size_t, AES::error>
+        cbc_decrypt(const AES::key_schedule& ks, AES::block& iv, nonstd::span<uint8_t> data) const noexcept {
+            if(data.size() % AES::BLOCK_SIZE) { return nonstd::make_unexpected(AES::error::BAD_LENGTH); }
+            AES::block chain = iv;
+            for(size_t i = 0; i < data.size(); i += AES::BLOCK_SIZE) {
+                const AES::block cipher = { data[i],    data[i+1],  data[i+2],  data[i+3],
+                                            data[i+4],  data[i+5],  data[i+6],  data[i+7],
+                                            data[i+8],  data[i+9],  data[i+10], data[i+11],
+                                            data[i+12], data[i+13], data[i+14], data[i+15] };
+                const auto r = process(ks.decrypt, &data[i], true, nullptr, chain.data());
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+                chain = cipher;
+            }
+            iv = chain;
+            return data.size();
+        }
+
+        /**
+         * CTR mode encrypt or decrypt in place. Any length is allowed. Only the cipher key is used.
+         * @param counter [IN/OUT] counter block, advanced once per block used. The unused part of the
+         *                         keystream of a partial final block is discarded.
+         */
+        [[nodiscard]] constexpr nonstd::expected<size_t, AES::error>
+        ctr_crypt(const AES::key_schedule& ks, AES::block& counter, nonstd::span<uint8_t> data) const noexcept {
+            for(size_t i = 0; i < data.size(); i += AES::BLOCK_SIZE) {
+                AES::block keystream = counter;
+                const auto r = process(ks.encrypt, keystream.data(), false);
+                if(!r) { return nonstd::make_unexpected(r.error()); }
+                AES::increment_counter(counter);
+                for(uint8_t j = 0; j < AES::BLOCK_SIZE && i + j < data.size(); ++j) {
+                    data[i + j] ^= keystream[j];
+                }
+            }
+            return data.size();
+        }
+    };
+
+    /**
+     * DMA fed AES-128 driver. Three DMA channels move the data so the CPU is free while a buffer is encrypted:
+     *  - OUT channel reads the finished state into the destination buffer
+     *  - KEY channel reloads the key memory for the next block
+     *  - IN channel writes the next block to the state memory, which starts the module in auto mode
+     * All three are triggered by the AES state ready trigger, and the first KEY and IN blocks are software
+     * triggered. The channels must be serviced in that order, so the DMA controller must be started with
+     * DMA::PRIORITY::CH0123 and the channels passed with ascending numbers.
+     *
+     * CBC encryption uses the XOR feature of the state memory, so the IN channel writes plaintext that is
+     * XORed with the previous ciphertext still in the state.
+     *
+     * Resources: three DMA channels for the duration of a transaction. The key schedule and both buffers
+     * must stay valid until done() returns true. Not available in the simulation build, use AES_Basic.
+     */
+    template <typename AES_INSTANCE, typename OUT_CHANNEL, typename KEY_CHANNEL, typename IN_CHANNEL>
+    class AES_DMA {
+        AES_INSTANCE m_instance;
+        DMA_Channel_Basic<OUT_CHANNEL> m_out;
+        DMA_Channel_Basic<KEY_CHANNEL> m_key;
+        DMA_Channel_Basic<IN_CHANNEL>  m_in;
+
+        static_assert(DMA_Channel_Basic<OUT_CHANNEL>::index < DMA_Channel_Basic<KEY_CHANNEL>::index
+                      && DMA_Channel_Basic<KEY_CHANNEL>::index < DMA_Channel_Basic<IN_CHANNEL>::index,
+                      "AES DMA channels must be in ascending order: OUT, KEY, IN");
+
+        /// check the request and that no transaction is running, and only then reset the module and start
+        [[nodiscard]] nonstd::expected<uint16_t, AES::error>
+        start_transfer(const AES::block& key, nonstd::span<const uint8_t> src, nonstd::span<uint8_t> dst, const bool decrypt,
+                       const AES::block* iv = nullptr) const noexcept {
+            const uint16_t blocks = src.size() / AES::BLOCK_SIZE;
+            if(src.size() % AES::BLOCK_SIZE || dst.size() < src.size() || blocks == 0 || blocks > DMA::MAX_REPEAT) {
+                return nonstd::make_unexpected(AES::error::BAD_LENGTH);
+            }
+            if(m_in.enabled() || m_out.enabled()) {
+                return nonstd::make_unexpected(AES::error::BUSY);
+            }
+
+            m_instance.CTRL = m_instance.CTRL.RESET.shift(true);
+            if(iv) {
+                for(const uint8_t& v : *iv) {
+                    m_instance.STATE = v;
+                }
+            }
+
+            const uint32_t state = m_instance.STATE.address;
+            m_out.set_source(state, DMA::SRC_MODE::FIXED, DMA::SRC_RELOAD::NONE);
+            m_out.set_destination(DMA::address_of(dst.data()), DMA::DEST_MODE::INC, DMA::DEST_RELOAD::NONE);
+            m_out.set_trigger(DMA::TRIGGER::AES, DMA::BURST_LENGTH::_8BYTE);
+            m_out.set_count(AES::BLOCK_SIZE, blocks);
+
+            m_key.set_source(DMA::address_of(key.data()), DMA::SRC_MODE::INC, DMA::SRC_RELOAD::BLOCK);
+            m_key.set_destination(m_instance.KEY.address, DMA::DEST_MODE::FIXED, DMA::DEST_RELOAD::NONE);
+            m_key.set_trigger(DMA::TRIGGER::AES, DMA::BURST_LENGTH::_8BYTE);
+            m_key.set_count(AES::BLOCK_SIZE, blocks);
+
+            m_in.set_source(DMA::address_of(src.data()), DMA::SRC_MODE::INC, DMA::SRC_RELOAD::NONE);
+            m_in.set_destination(state, DMA::DEST_MODE::FIXED, DMA::DEST_RELOAD::NONE);
+            m_in.set_trigger(DMA::TRIGGER::AES, DMA::BURST_LENGTH::_8BYTE);
+            m_in.set_count(AES::BLOCK_SIZE, blocks);
+
+            m_instance.CTRL = m_instance.CTRL.AUTO.shift(true)
+                            | m_instance.CTRL.DECRYPT.shift(decrypt)
+                            | m_instance.CTRL.XOR.shift(iv != nullptr);
+
+            m_out.enable();
+            m_key.enable();
+            m_in.enable();
+            m_key.request();
+            m_in.request();
+            return src.size();
+        }
+
+    public:
+        constexpr AES_DMA(const AES_INSTANCE instance, const OUT_CHANNEL out, const KEY_CHANNEL key, const IN_CHANNEL in)
+            : m_instance(instance), m_out(out), m_key(key), m_in(in)
+        {}
+
+        /// start an ECB encryption of src into dst. At most 255 blocks per transaction.
+        [[nodiscard]] nonstd::expected<uint16_t, AES::error>
+        start_ecb_encrypt(const AES::key_schedule& ks, nonstd::span<const uint8_t> src, nonstd::span<uint8_t> dst) const noexcept {
+            return start_transfer(ks.encrypt, src, dst, false);
+        }
+
+        /// start an ECB decryption of src into dst. At most 255 blocks per transaction.
+        [[nodiscard]] nonstd::expected<uint16_t, AES::error>
+        start_ecb_decrypt(const AES::key_schedule& ks, nonstd::span<const uint8_t> src, nonstd::span<uint8_t> dst) const noexcept {
+            return start_transfer(ks.decrypt, src, dst, true);
+        }
+
+        /**
+         * start a CBC encryption of src into dst. At most 255 blocks per transaction.
+         * The IV is written to the state memory by the CPU before the transfer starts. To continue a message
+         * in a later transaction pass the last ciphertext block as the IV.
+         */
+        [[nodiscard]] nonstd::expected<uint16_t, AES::error>
+        start_cbc_encrypt(const AES::key_schedule& ks, const AES::block& iv, nonstd::span<const uint8_t> src, nonstd::span<uint8_t> dst) const noexcept {
+            return start_transfer(ks.encrypt, src, dst, false, &iv);
+        }
+
+        /// true when the last block has been read out of the module
+        [[nodiscard]] constexpr bool done() const noexcept {
+            return !m_out.enabled();
+        }
+
+        /// true if the module or any of the channels reported an error
+        [[nodiscard]] constexpr bool failed() const noexcept {
+            const bool aes_error = m_instance.STATUS.ERROR;
+            return aes_error | m_out.error() | m_key.error() | m_in.error();
+        }
+
+        /// stops an ongoing transaction and leaves the module reset
+        constexpr void abort() const noexcept {
+            m_in.disable();
+            m_key.disable();
+            m_out.disable();
+            m_instance.CTRL = m_instance.CTRL.RESET.shift(true);
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
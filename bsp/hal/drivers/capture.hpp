@@ -0,0 +1,223 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/dma.hpp"      // moves the captures to RAM
+#include "drivers/evsys.hpp"    // routes the pin to the timer
+#include "drivers/tc.hpp"       // timestamps the edges
+#include "pin_types.hpp"
+#include <array>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace CAPTURE {
+        /// the timer counts to TOP. With PER below 0x8000 the MSB of a capture is the pin level.
+        inline constexpr uint16_t TOP = 0x7FFEU;
+        inline constexpr uint16_t PERIOD_MASK = 0x7FFFU;
+        inline constexpr uint16_t LEVEL_MASK = 0x8000U;
+        /// marks a buffer slot that was read. The count never reaches 0x7FFF, so no capture looks like it.
+        inline constexpr uint16_t CONSUMED = 0xFFFFU;
+
+        /// ticks from one capture time to a later one, across a wrap of the timer
+        [[nodiscard]] constexpr uint16_t elapsed(const uint16_t from, const uint16_t to) noexcept {
+            return static_cast<uint16_t>((to >= from) ? to - from : to + (TOP + 1U) - from);
+        }
+
+        /**
+         * DMA trigger for a compare/capture channel of a timer. The triggers of each port's timers start at
+         * 0x40 + 0x20 * port; type 0 has OVF, ERR, CCA-CCD and type 1 follows with OVF, ERR, CCA and CCB.
+         */
+        template <typename TC_INSTANCE, TC::CHANNEL CH>
+        constexpr DMA::TRIGGER dma_trigger() noexcept {
+            constexpr uint16_t port = (TC_INSTANCE::BaseAddress - decltype(device::TCC0)::BaseAddress) >> 8U;
+            constexpr uint8_t type1 = (TC_INSTANCE::BaseAddress & 0x40U) ? 6U : 0U;
+            return static_cast<DMA::TRIGGER>(0x40U + port * 0x20U + type1 + 2U + static_cast<uint8_t>(CH));
+        }
+
+        /// running statistics of a captured signal, in timer ticks
+        struct statistics {
+            uint32_t period_sum = 0;    // sum of all full periods
+            uint32_t high_sum = 0;      // sum of the high time of the same periods
+            uint16_t periods = 0;       // number of full periods (rising edge to rising edge)
+            uint16_t last_period = 0;
+            uint16_t last_high = 0;
+            uint16_t min_period = UINT16_MAX;
+            uint16_t max_period = 0;
+            uint16_t overflows = 0;     // times update() came too late and the DMA wrote over unread captures
+
+            [[nodiscard]] constexpr uint16_t mean_period() const noexcept {
+                return periods ? static_cast<uint16_t>(period_sum / periods) : 0;
+            }
+
+            /// high time as 1/1000ths of the period, averaged over all periods
+            [[nodiscard]] constexpr uint16_t duty_permille() const noexcept {
+                return period_sum ? static_cast<uint16_t>((static_cast<uint64_t>(high_sum) * 1000U) / period_sum) : 0;
+            }
+
+            /// mean frequency in Hz for a timer running at tick_hz
+            [[nodiscard]] constexpr uint32_t frequency(const uint32_t tick_hz) const noexcept {
+                return period_sum ? static_cast<uint32_t>((static_cast<uint64_t>(tick_hz) * periods + period_sum / 2U) / period_sum) : 0;
+            }
+        };
+    }   // namespace CAPTURE
+
+    /**
+     * Input capture of a pin without interrupts. Both edges of the pin go through an event channel to
+     * compare/capture channel A of a timer, and every capture triggers a DMA burst that copies it into a
+     * ring buffer in RAM. The CPU only reads the buffer, so no edge is lost to interrupt latency as long
+     * as fewer than SIZE edges arrive between calls of update(). update() marks every slot it reads, and
+     * finds the DMA a lap ahead when the last slot it read was written again: the unread captures are gone,
+     * statistics().overflows counts it and the period measurement starts over. The DMA takes a few cycles per edge, which keeps up
+     * with signals well into the hundreds of kHz; the timer's two level capture buffer absorbs DMA latency.
+     *
+     * The timer counts to 0x7FFE, so the MSB of each capture holds the pin level right after the edge and
+     * rising and falling edges are told apart without reading the pin. Periods must be shorter than 0x7FFF
+     * ticks: choose the timer clock so the slowest expected signal fits.
+     *
+     * update() drains the buffer and keeps running statistics: period (rising to rising), high time, duty
+     * cycle and frequency. Sums are 32-bit, call reset_statistics() at least every 65535 periods.
+     *
+     * Resources: the timer (channel A), the event channel, the DMA channel and 2 * SIZE bytes of RAM for the
+     * buffer. The DMA controller must be enabled. The DMA writes to this object, so it must not move or go
+     * out of scope while running.
+     *
+     * example: drivers::InputCapture<decltype(device::TCC0), decltype(device::DMA.CH0), decltype(device::EVSYS), 0> capture(...);
+     *          capture.start(GPIO::pin<decltype(device::PORTC), 2>{}, drivers::TC::CLOCK::DIV8);
+     * @tparam EVENT_CH event channel used to route the pin
+     * @tparam SIZE captures held by the ring buffer, a power of two
+     */
+    template <typename TC_INSTANCE, typename DMA_CHANNEL, typename EVSYS_INSTANCE, uint8_t EVENT_CH, uint8_t SIZE = 32>
+    class InputCapture {
+        static_assert(SIZE >= 2 && SIZE <= 128 && (SIZE & (SIZE - 1U)) == 0, "Capture buffer size must be a power of two from 2 to 128");
+
+        static constexpr uint16_t BLOCK_SIZE = SIZE * sizeof(uint16_t);
+
+        TC_Basic<TC_INSTANCE> m_timer;
+        DMA_Channel_Basic<DMA_CHANNEL> m_dma;
+        EVSYS_Basic<EVSYS_INSTANCE> m_events;
+
+        std::array<volatile uint16_t, SIZE> m_buffer{};
+        uint8_t m_tail = 0;
+        bool m_has_rise = false;
+        bool m_has_high = false;
+        uint16_t m_rise = 0;
+        CAPTURE::statistics m_stats{};
+
+        /// index of the next capture the DMA will write. A burst in progress is not counted.
+        [[nodiscard]] uint8_t head() const noexcept {
+            return static_cast<uint8_t>((BLOCK_SIZE - m_dma.remaining()) / sizeof(uint16_t)) & (SIZE - 1U);
+        }
+
+        void consume(const uint16_t capture) noexcept {
+            const uint16_t time = capture & CAPTURE::PERIOD_MASK;
+            if(capture & CAPTURE::LEVEL_MASK) {
+                // a period is complete at the rising edge after it, if its falling edge was seen too
+                if(m_has_high) {
+                    const uint16_t period = CAPTURE::elapsed(m_rise, time);
+                    m_stats.last_period = period;
+                    m_stats.period_sum += period;
+                    m_stats.high_sum += m_stats.last_high;
+                    ++m_stats.periods;
+                    if(period < m_stats.min_period) { m_stats.min_period = period; }
+                    if(period > m_stats.max_period) { m_stats.max_period = period; }
+                }
+                m_rise = time;
+                m_has_rise = true;
+                m_has_high = false;
+            }
+            else if(m_has_rise) {
+                m_stats.last_high = CAPTURE::elapsed(m_rise, time);
+                m_has_high = true;
+            }
+        }
+
+    public:
+        constexpr InputCapture(const TC_INSTANCE timer, const DMA_CHANNEL dma, const EVSYS_INSTANCE events)
+            : m_timer(timer), m_dma(dma), m_events(events)
+        {}
+
+        /**
+         * Route the pin and start capturing. The pin is made an input and sensing both edges is forced.
+         * @param pin [IN] pin on port A-F
+         * @param clock [IN] timer clock, the tick of all reported times
+         * @param config [IN] additional pin configuration, like a pull-up
+         * @param filter [IN] digital filter on the event channel to reject glitches
+         */
+        template <class PORT, uint8_t PIN>
+        void start(const GPIO::pin<PORT, PIN> pin, const TC::CLOCK clock,
+                   const GPIO::PinConfig config = GPIO::PinConfig::SENSE_BOTHEDGES,
+                   const EVSYS::FILTER filter = EVSYS::FILTER::_1SAMPLE) noexcept {
+            pin.set_input();
+            pin.configure(static_cast<GPIO::PinConfig>(static_cast<uint8_t>(config) & ~0x07U));
+            m_events.template set_source<EVENT_CH>(EVSYS::pin_source(pin));
+            m_events.template set_filter<EVENT_CH>(filter);
+
+            m_dma.disable();
+            m_dma.set_source(decltype(TC_INSTANCE::CCA)::address, DMA::SRC_MODE::INC, DMA::SRC_RELOAD::BURST);
+            m_dma.set_destination(DMA::address_of(m_buffer.data()), DMA::DEST_MODE::INC, DMA::DEST_RELOAD::BLOCK);
+            m_dma.set_count(BLOCK_SIZE, 0);
+            m_dma.set_trigger(CAPTURE::dma_trigger<TC_INSTANCE, TC::CHANNEL::A>(), DMA::BURST_LENGTH::_2BYTE, true);
+            for(auto& slot : m_buffer) { slot = CAPTURE::CONSUMED; }
+            m_tail = 0;
+            m_has_rise = false;
+            m_has_high = false;
+            reset_statistics();
+            m_dma.enable();
+
+            m_timer.stop();
+            m_timer.reset();
+            m_timer.set_event(static_cast<TC::EVENT_SOURCE>(EVSYS::channel_select<EVENT_CH>()), TC::EVENT_ACTION::CAPT);
+            m_timer.template enable_channel<TC::CHANNEL::A>();
+            m_timer.start(clock, CAPTURE::TOP);
+        }
+
+        /// stop the timer and the DMA, and disconnect the pin. The statistics are kept.
+        void stop() noexcept {
+            m_timer.stop();
+            m_dma.disable();
+            m_events.template set_source<EVENT_CH>(EVSYS::SOURCE::OFF);
+        }
+
+        /**
+         * Process all new captures. If SIZE or more edges arrived since the last call, only the ones written
+         * after the last slot read are processed, and the edges before them are lost.
+         * @return number of edges processed
+         */
+        uint8_t update() noexcept {
+            const uint8_t end = head();
+            const uint8_t last = (m_tail - 1U) & (SIZE - 1U);
+            if(m_buffer[last] != CAPTURE::CONSUMED) {
+                m_buffer[last] = CAPTURE::CONSUMED;
+                ++m_stats.overflows;
+                m_has_rise = false;
+                m_has_high = false;
+            }
+            uint8_t count = 0;
+            for(; m_tail != end; m_tail = (m_tail + 1U) & (SIZE - 1U), ++count) {
+                consume(m_buffer[m_tail]);
+                m_buffer[m_tail] = CAPTURE::CONSUMED;
+            }
+            return count;
+        }
+
+        /// clear the statistics. The last edge is kept, so the period in progress is still measured.
+        void reset_statistics() noexcept {
+            m_stats = {};
+        }
+
+        [[nodiscard]] const CAPTURE::statistics& statistics() const noexcept { return m_stats; }
+
+        /// true if the timer's capture buffer overflowed because the DMA fell behind. Clears the flag.
+        [[nodiscard]] bool overrun() const noexcept {
+            return m_timer.error();
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -6,6 +6,8 @@
 
 #include "pin_types.hpp"
 #include "device.hpp"
+#include "drivers/cpu.hpp"          // protected writes to the clock registers
+#include "nonstd/expected.hpp"      // std::expected implementation for safe return value
 #include <cstdint>
 
 namespace drivers {
@@ -17,36 +19,248 @@ namespace drivers {
         using PRESCALE_A = sfr::CLK::PSADIVv;
         using PRESCALE_B_C = sfr::CLK::PSBCDIVv;
         using PRESCALE_USB = sfr::CLK::USBPSDIVv;
+        using PLL_SOURCE = sfr::OSC::PLLSRCv;
+        using XOSC_SELECT = sfr::OSC::XOSCSELv;
+        using XOSC_RANGE = sfr::OSC::FRQRANGEv;
+        using DFLL_REFERENCE = sfr::OSC::RC32MCREFv;
+        using DFLL2M_REFERENCE = sfr::OSC::RC2MCREFv;
 
+        /// list of clock errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            TIMEOUT = (1U<<7U),
+            NONE = (1U<<0U)
+        };
+
+        /// oscillators, the bits are the same in OSC.CTRL and OSC.STATUS
+        enum class OSCILLATOR : uint8_t {
+            RC2M = 0x01,
+            RC32M = 0x02,
+            RC32K = 0x04,
+            XOSC = 0x08,
+            PLL = 0x10
+        };
+
+        /// busy wait iterations before an oscillator is declared dead. A 32.768 kHz crystal takes up to a second.
+        inline constexpr uint32_t STARTUP_LOOPS = 1'000'000UL;
+
+        inline constexpr uint32_t MAX_CPU_HZ = 32'000'000UL;
+        inline constexpr uint32_t RC2M_HZ = 2'000'000UL;
+        inline constexpr uint32_t RC32M_HZ = 32'000'000UL;
+        inline constexpr uint32_t RC32K_HZ = 32'768UL;
+
+        constexpr uint16_t divider(const PRESCALE_A a) noexcept {
+            const auto v = static_cast<uint8_t>(a);
+            return v == 0 ? 1U : static_cast<uint16_t>(1U << ((v + 1U) / 2U));
+        }
+        constexpr uint8_t divider_b(const PRESCALE_B_C bc) noexcept {
+            return bc == PRESCALE_B_C::_4_1 ? 4U : (bc == PRESCALE_B_C::_2_2 ? 2U : 1U);
+        }
+        constexpr uint8_t divider_c(const PRESCALE_B_C bc) noexcept {
+            return (bc == PRESCALE_B_C::_1_2 || bc == PRESCALE_B_C::_2_2) ? 2U : 1U;
+        }
+
+        /**
+         * PLL output frequency, checked at compile time. The 32 MHz RC oscillator feeds the PLL divided by 4.
+         * example: drivers::CLK::pll_hz<drivers::CLK::PLL_SOURCE::RC2M, 16>() is 32 MHz
+         * @tparam InputHz frequency of the external oscillator, only used with PLL_SOURCE::XOSC
+         */
+        template <PLL_SOURCE Source, uint8_t Factor, uint32_t InputHz = 0>
+        constexpr uint32_t pll_hz() noexcept {
+            static_assert(Factor >= 1 && Factor <= 31, "PLL multiplication factor must be 1 to 31");
+            constexpr uint32_t input = Source == PLL_SOURCE::RC2M ? RC2M_HZ : (Source == PLL_SOURCE::RC32M ? RC32M_HZ / 4U : InputHz);
+            static_assert(input >= 400'000UL, "PLL input must be at least 0.4 MHz");
+            constexpr uint32_t output = input * Factor;
+            static_assert(output >= 10'000'000UL && output <= 200'000'000UL, "PLL output must be 10 to 200 MHz");
+            return output;
+        }
+
+        /// DFLL compare value for a target frequency. The DFLL counts oscillator cycles per 1.024 kHz reference tick.
+        template <uint32_t Hz>
+        constexpr uint16_t dfll_compare() noexcept {
+            constexpr uint32_t compare = (Hz + 512U) / 1024U;
+            static_assert(compare > 0 && compare <= 0xFFFFU, "DFLL target frequency is out of range");
+            return static_cast<uint16_t>(compare);
+        }
+
+        /**
+         * A system clock configuration with every derived frequency known at compile time. The board picks one
+         * and hands cpu_hz to the baud rate and prescaler solvers, so they always match the running clock.
+         * example: using SystemClock = drivers::CLK::tree<drivers::CLK::SYSTEM_SOURCE::RC32M, drivers::CLK::RC32M_HZ>;
+         * @tparam SourceHz frequency of the selected source, see pll_hz() for the PLL
+         * @tparam A prescaler A, system clock to clkPER4
+         * @tparam BC prescalers B and C, clkPER4 to clkPER2 to clkPER and clkCPU
+         */
+        template <SYSTEM_SOURCE Source, uint32_t SourceHz, PRESCALE_A A = PRESCALE_A::_1, PRESCALE_B_C BC = PRESCALE_B_C::_1_1>
+        struct tree {
+            static constexpr SYSTEM_SOURCE source = Source;
+            static constexpr PRESCALE_A prescale_a = A;
+            static constexpr PRESCALE_B_C prescale_b_c = BC;
+
+            static constexpr uint32_t system_hz = SourceHz;
+            static constexpr uint32_t per4_hz = system_hz / divider(A);
+            static constexpr uint32_t per2_hz = per4_hz / divider_b(BC);
+            static constexpr uint32_t per_hz = per2_hz / divider_c(BC);
+            static constexpr uint32_t cpu_hz = per_hz;
+
+            static_assert(cpu_hz <= MAX_CPU_HZ, "CPU and peripheral clock must be 32 MHz or less");
+            static_assert(per4_hz <= 4U * MAX_CPU_HZ, "clkPER4 must be 128 MHz or less");
+            static_assert(Source != SYSTEM_SOURCE::RC2M || SourceHz == RC2M_HZ, "The 2 MHz RC oscillator runs at 2 MHz");
+            static_assert(Source != SYSTEM_SOURCE::RC32K || SourceHz == RC32K_HZ, "The 32 kHz RC oscillator runs at 32.768 kHz");
+        };
+
+        /// the clock after reset
+        using RC2M_2MHZ = tree<SYSTEM_SOURCE::RC2M, RC2M_HZ>;
+        /// the 32 MHz RC oscillator, locked to a crystal or the internal 32 kHz oscillator by the DFLL
+        using RC32M_32MHZ = tree<SYSTEM_SOURCE::RC32M, RC32M_HZ>;
+        /// the 2 MHz RC oscillator multiplied by 16
+        using PLL_RC2M_32MHZ = tree<SYSTEM_SOURCE::PLL, pll_hz<PLL_SOURCE::RC2M, 16>()>;
     } // namespace CLK
 
+    /**
+     * Zero overhead driver for the oscillators and the PLL, for example: drivers::OSC_Basic osc(device::OSC);
+     */
+    template <typename OSC_INSTANCE>
+    class OSC_Basic {
+        OSC_INSTANCE m_instance;
+//        decltype(device::OSC) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr OSC_Basic(const OSC_INSTANCE instance) : m_instance(instance) {}
+
+        /// enable an oscillator and wait until it is stable
+        [[nodiscard]] nonstd::expected<void, CLK::error> start(const CLK::OSCILLATOR osc) const noexcept {
+            m_instance.CTRL = m_instance.CTRL.read() | static_cast<uint8_t>(osc);
+            for(uint32_t countdown = CLK::STARTUP_LOOPS; countdown > 0; --countdown) {
+                if(ready(osc)) { return {}; }
+            }
+            return nonstd::make_unexpected(CLK::error::TIMEOUT);
+        }
+
+        /// disable an oscillator. The oscillator used by the system clock can't be stopped.
+        constexpr void stop(const CLK::OSCILLATOR osc) const noexcept {
+            m_instance.CTRL = m_instance.CTRL.read() & static_cast<uint8_t>(~static_cast<uint8_t>(osc));
+        }
+
+        [[nodiscard]] constexpr bool ready(const CLK::OSCILLATOR osc) const noexcept {
+            return m_instance.STATUS.read() & static_cast<uint8_t>(osc);
+        }
+
+        /**
+         * Configure the external oscillator or clock input, before starting it.
+         * @param low_power [IN] low power mode of the 32.768 kHz crystal oscillator
+         * @param high_power [IN] high power mode of the 0.4-16 MHz crystal oscillator
+         */
+        constexpr void configure_xosc(const CLK::XOSC_SELECT select, const CLK::XOSC_RANGE range = CLK::XOSC_RANGE::_04TO2,
+                                      const bool low_power = false, const bool high_power = false) const noexcept {
+            m_instance.XOSCCTRL = m_instance.XOSCCTRL.FRQRANGE.shift(range)
+                                | m_instance.XOSCCTRL.X32KLPM.shift(low_power)
+                                | m_instance.XOSCCTRL.XOSCPWR.shift(high_power)
+                                | m_instance.XOSCCTRL.XOSCSEL.shift(select);
+        }
+
+        /// configure the PLL before starting it, see CLK::pll_hz()
+        void configure_pll(const CLK::PLL_SOURCE source, const uint8_t factor) const noexcept {
+            CPU::protected_write(m_instance.PLLCTRL, static_cast<uint8_t>(
+                                 m_instance.PLLCTRL.PLLSRC.shift(source).value | m_instance.PLLCTRL.PLLFAC.shift(factor).value));
+        }
+
+        /// select the reference the DFLLs lock the RC oscillators to
+        constexpr void set_dfll_reference(const CLK::DFLL_REFERENCE rc32m, const CLK::DFLL2M_REFERENCE rc2m = CLK::DFLL2M_REFERENCE::RC32K) const noexcept {
+            m_instance.DFLLCTRL = m_instance.DFLLCTRL.RC32MCREF.shift(rc32m) | m_instance.DFLLCTRL.RC2MCREF.shift(rc2m == CLK::DFLL2M_REFERENCE::XOSC32K);
+        }
+    };
+
+    /**
+     * Zero overhead driver for the DFLL of an RC oscillator, for example: drivers::DFLL_Basic dfll(device::DFLLRC32M);
+     * The DFLL continuously trims the oscillator against the reference selected with
+     * OSC_Basic::set_dfll_reference(), which takes the RC oscillator from about 1% to the accuracy of the
+     * reference. The reference oscillator must be running before the DFLL is started.
+     */
+    template <typename DFLL_INSTANCE>
+    class DFLL_Basic {
+        DFLL_INSTANCE m_instance;
+//        decltype(device::DFLLRC32M) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr DFLL_Basic(const DFLL_INSTANCE instance) : m_instance(instance) {}
+
+        /// start tracking the reference, with a compare value from CLK::dfll_compare()
+        constexpr void start(const uint16_t compare) const noexcept {
+            m_instance.COMP1 = static_cast<uint8_t>(compare & 0xFFU);
+            m_instance.COMP2 = static_cast<uint8_t>(compare >> 8U);
+            m_instance.CTRL.ENABLE = true;
+        }
+
+        /// stop tracking, the oscillator keeps its last calibration
+        constexpr void stop() const noexcept {
+            m_instance.CTRL.ENABLE = false;
+        }
+    };
+
+    /**
+     * Zero overhead driver for the clock system, for example: drivers::CLK_Basic clk(device::CLK);
+     * Switching the system clock is a protected write, the sequence is handled here.
+     */
     template <typename CLK_INSTANCE>
     class CLK_Basic {
-//        CLK_INSTANCE m_instance;
-        decltype(device::CLK) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+        CLK_INSTANCE m_instance;
+//        decltype(device::CLK) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
     public:
         constexpr CLK_Basic(const CLK_INSTANCE clkInst) : m_instance(clkInst) {}
 
-        constexpr void set_system_clock(const CLK::SYSTEM_SOURCE src, const CLK::PRESCALE_A preA, const CLK::PRESCALE_B_C preBC) const noexcept {
-            m_instance.CTRL = m_instance.CTRL.SCLKSEL.shift(src);
-            m_instance.PSCTRL = m_instance.PSCTRL.PSADIV.shift(preA) | m_instance.PSCTRL.PSBCDIV.shift(preBC);
+        /// set the prescalers and switch the system clock. The source must already be running.
+        void set_system_clock(const CLK::SYSTEM_SOURCE src, const CLK::PRESCALE_A preA, const CLK::PRESCALE_B_C preBC) const noexcept {
+            CPU::protected_write(m_instance.PSCTRL, static_cast<uint8_t>(
+                                 m_instance.PSCTRL.PSADIV.shift(preA).value | m_instance.PSCTRL.PSBCDIV.shift(preBC).value));
+            CPU::protected_write(m_instance.CTRL, static_cast<uint8_t>(m_instance.CTRL.SCLKSEL.shift(src).value));
+        }
+
+        /// switch to a clock tree from CLK::tree. The source must already be running.
+        template <typename TREE>
+        void set_system_clock() const noexcept {
+            set_system_clock(TREE::source, TREE::prescale_a, TREE::prescale_b_c);
+        }
+
+        /// lock the system clock configuration until the next reset
+        void lock() const noexcept {
+            CPU::protected_write(m_instance.LOCK, m_instance.LOCK.LOCK.shift(true).value);
         }
 
         constexpr void enable_rtc(const CLK::RTC_SOURCE src) const noexcept {
             m_instance.RTCCTRL = m_instance.RTCCTRL.RTCSRC.shift(src) | m_instance.RTCCTRL.RTCEN.shift(true);
         }
-        constexpr void disable_rtc(const CLK::RTC_SOURCE src) const noexcept {
-            m_instance.RTCCTRL &= ~m_instance.RTCCTRL.RTCEN.shift(false);
+        constexpr void disable_rtc() const noexcept {
+            m_instance.RTCCTRL.RTCEN = false;
         }
 
         constexpr void enable_usb(const CLK::USB_SOURCE src, const CLK::PRESCALE_USB prescale) const noexcept {
             m_instance.USBCTRL = m_instance.USBCTRL.USBPSDIV.shift(prescale) | m_instance.USBCTRL.USBSRC.shift(src) | m_instance.USBCTRL.USBSEN.shift(true);
         }
-        constexpr void disable_usb(const CLK::RTC_SOURCE src) const noexcept {
-            m_instance.USBCTRL &= ~m_instance.USBCTRL.USBSEN.shift(false);
+        constexpr void disable_usb() const noexcept {
+            m_instance.USBCTRL.USBSEN = false;
         }
     };
 
+    namespace CLK {
+        /**
+         * Bring up the 32 MHz RC oscillator locked to the 32.768 kHz crystal and switch the system clock to it.
+         * The 2 MHz oscillator is stopped afterwards. On a timeout the system clock is left unchanged.
+         * @tparam TREE a tree on SYSTEM_SOURCE::RC32M, usually CLK::RC32M_32MHZ
+         */
+        template <typename TREE = RC32M_32MHZ, typename CLK_INSTANCE, typename OSC_INSTANCE, typename DFLL_INSTANCE>
+        [[nodiscard]] nonstd::expected<void, error> start_rc32m_dfll(const CLK_Basic<CLK_INSTANCE>& clk, const OSC_Basic<OSC_INSTANCE>& osc,
+                                                                    const DFLL_Basic<DFLL_INSTANCE>& dfll) noexcept {
+            static_assert(TREE::source == SYSTEM_SOURCE::RC32M, "The clock tree must run from the 32 MHz RC oscillator");
+            osc.configure_xosc(XOSC_SELECT::_32KHz);
+            if(auto r = osc.start(OSCILLATOR::XOSC); !r) { return r; }
+            if(auto r = osc.start(OSCILLATOR::RC32M); !r) { return r; }
+            osc.set_dfll_reference(DFLL_REFERENCE::XOSC32K);
+            dfll.start(dfll_compare<TREE::system_hz>());
+            clk.template set_system_clock<TREE>();
+            osc.stop(OSCILLATOR::RC2M);
+            return {};
+        }
+    } // namespace CLK
+
 } // namespace drivers
 
 #if __clang__
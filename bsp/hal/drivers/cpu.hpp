@@ -0,0 +1,81 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include <cstdint>
+
+namespace drivers {
+
+    namespace CPU {
+        using CCP_SIGNATURE = sfr::CPU::CCPv;
+
+        /**
+         * Write a register protected by the configuration change protection. The signature is written to CCP
+         * and the register must be written within 4 cycles, so both writes are done in assembly. Interrupts are
+         * held off by hardware for those 4 cycles.
+         * example: drivers::CPU::protected_write(device::CLK.CTRL, value);
+         * @param reg [IN] the register to write. Must be an IOREG protected register.
+         * @param value [IN] value to write to the register
+         */
+        template <typename REG>
+        inline void protected_write(const REG reg, const uint8_t value) noexcept {
+#if SIMULATION_BUILD
+            REG::write(value);
+#else
+            asm volatile(
+                "out %[ccp], %[signature] \n\t"
+                "sts %[reg], %[value]     \n\t"
+                :
+                : [ccp] "I" (decltype(device::CPU)::CCP_t::address),
+                  [signature] "r" (static_cast<uint8_t>(CCP_SIGNATURE::IOREG)),
+                  [reg] "n" (REG::address),
+                  [value] "r" (value)
+                : "memory"
+            );
+#endif
+        }
+
+        /// enable interrupts globally
+        inline void enable_interrupts() noexcept {
+#if !SIMULATION_BUILD
+            asm volatile("sei" ::: "memory");
+#endif
+        }
+
+        /// disable interrupts globally
+        inline void disable_interrupts() noexcept {
+#if !SIMULATION_BUILD
+            asm volatile("cli" ::: "memory");
+#endif
+        }
+
+        /**
+         * Disables interrupts for its lifetime and restores the previous interrupt state when it goes out of
+         * scope, so it nests and can be used from ISRs.
+         * example: { drivers::CPU::critical_section lock; shared = value; }
+         */
+        class critical_section {
+            uint8_t m_sreg;
+        public:
+            critical_section() noexcept
+                : m_sreg(decltype(device::CPU)::SREG.read())
+            {
+                disable_interrupts();
+            }
+            ~critical_section() noexcept {
+                decltype(device::CPU)::SREG = m_sreg;
+            }
+            critical_section(const critical_section&) = delete;
+            critical_section& operator=(const critical_section&) = delete;
+        };
+
+    }   // namespace CPU
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,242 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"           // need this to forward the enum definitions
+#include "drivers/dma.hpp"      // feeds the DAC for waveform playback
+#include "nonstd/span.hpp"      // span for non-owning sample buffers
+#include <array>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace DAC {
+        using CHANNELS = sfr::DAC::CHSELv;
+        using REFERENCE = sfr::DAC::REFSELv;
+        using EVENT_SELECT = sfr::DAC::EVSELv;
+
+        /// largest output value, the DAC is 12 bits
+        inline constexpr uint16_t MAX_VALUE = 0x0FFFU;
+    }   // namespace DAC
+
+    /**
+     * Zero overhead driver for the 12-bit DAC, for example: drivers::DAC_Basic dac(device::DACB);
+     * Without event triggers a conversion starts when the high byte of a data register is written. With
+     * event triggers the data registers are double buffered and each event converts the last value written,
+     * so a timer event sets the sample rate without jitter.
+     */
+    template <typename DAC_INSTANCE>
+    class DAC_Basic {
+        DAC_INSTANCE m_instance;
+//        decltype(device::DACB) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        /// DMA trigger for a channel's data register empty condition. DACA triggers start at 0x15, DACB at 0x25.
+        template <uint8_t CH>
+        static constexpr DMA::TRIGGER dma_trigger() noexcept {
+            static_assert(CH < 2, "The DAC only has channels 0 and 1");
+            constexpr uint16_t dac = (DAC_INSTANCE::BaseAddress - 0x300U) >> 5U;
+            return static_cast<DMA::TRIGGER>(0x15U + dac * 0x10U + CH);
+        }
+
+        /// data space address of a channel's data register, for DMA
+        template <uint8_t CH>
+        static constexpr uint32_t data_address() noexcept {
+            static_assert(CH < 2, "The DAC only has channels 0 and 1");
+            if constexpr (CH == 0) { return decltype(DAC_INSTANCE::CH0DATA)::address; }
+            else { return decltype(DAC_INSTANCE::CH1DATA)::address; }
+        }
+
+        constexpr DAC_Basic(const DAC_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /**
+         * Configure the channels and the reference. The DAC must be stopped.
+         * @param channels [IN] channel 0, channel 1, or both
+         * @param left_adjust [IN] values are left adjusted 16-bit instead of right adjusted 12-bit
+         */
+        constexpr void init(const DAC::CHANNELS channels, const DAC::REFERENCE ref = DAC::REFERENCE::AVCC,
+                            const bool left_adjust = false) const noexcept {
+            m_instance.CTRLB.CHSEL = channels;
+            m_instance.CTRLC = m_instance.CTRLC.REFSEL.shift(ref) | m_instance.CTRLC.LEFTADJ.shift(left_adjust);
+        }
+
+        /// enable the DAC and the pin outputs of the channels in use
+        constexpr void start(const bool ch0 = true, const bool ch1 = false, const bool low_power = false) const noexcept {
+            m_instance.CTRLA = m_instance.CTRLA.CH0EN.shift(ch0)
+                             | m_instance.CTRLA.CH1EN.shift(ch1)
+                             | m_instance.CTRLA.LPMODE.shift(low_power)
+                             | m_instance.CTRLA.ENABLE.shift(true);
+        }
+
+        constexpr void stop() const noexcept {
+            m_instance.CTRLA.ENABLE = false;
+        }
+
+        /**
+         * Convert on events instead of on writes.
+         * @param select [IN] event channel for channel 0, and for channel 1 unless split
+         * @param split [IN] channel 1 listens to the next event channel
+         */
+        constexpr void set_event(const DAC::EVENT_SELECT select, const bool ch0 = true, const bool ch1 = false, const bool split = false) const noexcept {
+            m_instance.EVCTRL = m_instance.EVCTRL.EVSEL.shift(select) | m_instance.EVCTRL.EVSPLIT.shift(split);
+            m_instance.CTRLB.CH0TRIG = ch0;
+            m_instance.CTRLB.CH1TRIG = ch1;
+        }
+
+        /// set the calibration values, usually taken from the production signature row
+        template <uint8_t CH>
+        constexpr void set_calibration(const uint8_t gain, const uint8_t offset) const noexcept {
+            static_assert(CH < 2, "The DAC only has channels 0 and 1");
+            if constexpr (CH == 0) { m_instance.CH0GAINCAL = gain; m_instance.CH0OFFSETCAL = offset; }
+            else { m_instance.CH1GAINCAL = gain; m_instance.CH1OFFSETCAL = offset; }
+        }
+
+        /// true if the channel's data register can take a new value
+        template <uint8_t CH>
+        [[nodiscard]] constexpr bool ready() const noexcept {
+            static_assert(CH < 2, "The DAC only has channels 0 and 1");
+            if constexpr (CH == 0) { return m_instance.STATUS.CH0DRE; }
+            else { return m_instance.STATUS.CH1DRE; }
+        }
+
+        /// write a value. Without event triggers this starts a conversion.
+        template <uint8_t CH>
+        constexpr void write(const uint16_t value) const noexcept {
+            static_assert(CH < 2, "The DAC only has channels 0 and 1");
+            if constexpr (CH == 0) { m_instance.CH0DATA = value; }
+            else { m_instance.CH1DATA = value; }
+        }
+
+        /// wait until the data register is free, then write
+        template <uint8_t CH>
+        constexpr void write_blocking(const uint16_t value) const noexcept {
+            while(!ready<CH>()) {}
+            write<CH>(value);
+        }
+    };
+
+    /**
+     * Continuous waveform playback on one DAC channel, fed by DMA. The DAC converts on each event of the
+     * sample rate event channel, and every conversion triggers a 2 byte DMA burst with the next sample,
+     * so the CPU is not involved per sample.
+     *
+     * stream() plays SRAM buffers in ping-pong with a pair of DMA channels in double buffer mode: while one
+     * half plays, service() hands the finished half to a refill function, which writes the next SAMPLES values.
+     * The DMA can only read data memory, so tables in flash are copied in by the refill function, for example
+     * from a flash::far_array with copy_to(). loop() plays one SRAM table over and over with a single channel.
+     *
+     * Requirements: the DMA controller must be started with double buffering for the channel pair (CH01 or
+     * CH23), and the DAC must be configured for the channel with an event trigger, see DAC_Basic::set_event().
+     * Resources: both DMA channels of the pair and 4 * SAMPLES bytes of RAM. The DMA reads this object, so it
+     * must not move or go out of scope while playing.
+     *
+     * example: drivers::DAC_Stream<decltype(device::DACB), decltype(device::DMA.CH0), decltype(device::DMA.CH1), 0, 64>
+     *              audio(device::DACB, device::DMA.CH0, device::DMA.CH1);
+     *          audio.stream(fill);  ...  audio.service(fill);
+     * @tparam CH DAC channel
+     * @tparam SAMPLES samples in each half of the ping-pong buffer
+     */
+    template <typename DAC_INSTANCE, typename DMA_CHANNEL_A, typename DMA_CHANNEL_B, uint8_t CH, uint16_t SAMPLES>
+    class DAC_Stream {
+        static_assert(DMA_Channel_Basic<DMA_CHANNEL_A>::index % 2 == 0 && DMA_Channel_Basic<DMA_CHANNEL_B>::index == DMA_Channel_Basic<DMA_CHANNEL_A>::index + 1,
+                      "Ping-pong playback needs a double buffer pair of DMA channels: CH0 and CH1, or CH2 and CH3");
+        static_assert(SAMPLES > 0 && SAMPLES <= DMA::MAX_BLOCK_SIZE / 2U, "A buffer half must fit in one DMA block");
+
+        DAC_Basic<DAC_INSTANCE> m_dac;
+        DMA_Channel_Basic<DMA_CHANNEL_A> m_dma_a;
+        DMA_Channel_Basic<DMA_CHANNEL_B> m_dma_b;
+        std::array<std::array<uint16_t, SAMPLES>, 2> m_buffer{};
+        uint8_t m_next = 0;     // half that finishes next
+        uint16_t m_underruns = 0;
+
+        template <typename CHANNEL>
+        void setup(const CHANNEL& dma, const uint32_t source, const uint16_t bytes, const uint8_t repeat) const noexcept {
+            dma.disable();
+            dma.set_source(source, DMA::SRC_MODE::INC, DMA::SRC_RELOAD::BLOCK);
+            dma.set_destination(DAC_Basic<DAC_INSTANCE>::template data_address<CH>(), DMA::DEST_MODE::INC, DMA::DEST_RELOAD::BURST);
+            dma.set_count(bytes, repeat);
+            dma.set_trigger(DAC_Basic<DAC_INSTANCE>::template dma_trigger<CH>(), DMA::BURST_LENGTH::_2BYTE, true);
+        }
+
+        /// point a finished channel at its half again. The controller enables it when its partner finishes.
+        template <typename CHANNEL>
+        void reload(const CHANNEL& dma, const uint8_t half) const noexcept {
+            dma.set_source(DMA::address_of(m_buffer[half].data()), DMA::SRC_MODE::INC, DMA::SRC_RELOAD::BLOCK);
+            dma.set_count(SAMPLES * sizeof(uint16_t), 1);
+        }
+
+    public:
+        constexpr DAC_Stream(const DAC_INSTANCE dac, const DMA_CHANNEL_A dma_a, const DMA_CHANNEL_B dma_b)
+            : m_dac(dac), m_dma_a(dma_a), m_dma_b(dma_b)
+        {}
+
+        /**
+         * Fill both halves and start ping-pong playback. Only channel A is enabled; in double buffer mode the
+         * DMA controller enables B when A finishes, and the other way round.
+         * @param refill [IN] callable as refill(nonstd::span<uint16_t>) that fills all SAMPLES values
+         */
+        template <typename REFILL>
+        void stream(REFILL&& refill) noexcept {
+            refill(nonstd::span<uint16_t>(m_buffer[0]));
+            refill(nonstd::span<uint16_t>(m_buffer[1]));
+            setup(m_dma_a, DMA::address_of(m_buffer[0].data()), SAMPLES * sizeof(uint16_t), 1);
+            setup(m_dma_b, DMA::address_of(m_buffer[1].data()), SAMPLES * sizeof(uint16_t), 1);
+            (void)m_dma_a.complete();
+            (void)m_dma_b.complete();
+            m_next = 0;
+            m_underruns = 0;
+            m_dma_a.enable();
+        }
+
+        /**
+         * Refill the halves that finished playing and reload their channels, which the DMA controller enables
+         * again in turn. Never enables a channel itself, so only one channel answers each DAC trigger. Call it
+         * from the DMA transaction complete interrupt or often enough from the main loop, within SAMPLES
+         * sample periods. If the other half finished as well, the controller has already started the half
+         * that is about to be refilled again with its old samples; that is counted in underruns().
+         * @return number of halves refilled
+         */
+        template <typename REFILL>
+        uint8_t service(REFILL&& refill) noexcept {
+            uint8_t count = 0;
+            for(;;) {
+                const bool done = (m_next == 0) ? m_dma_a.complete() : m_dma_b.complete();
+                if(!done) { return count; }
+                if((m_next == 0) ? m_dma_b.finished() : m_dma_a.finished()) { ++m_underruns; }
+                refill(nonstd::span<uint16_t>(m_buffer[m_next]));
+                if(m_next == 0) { reload(m_dma_a, 0); } else { reload(m_dma_b, 1); }
+                m_next ^= 1U;
+                ++count;
+            }
+        }
+
+        /**
+         * Play a table in SRAM over and over with channel A, until stop(). The table is used in place and
+         * must stay valid while playing.
+         */
+        void loop(const nonstd::span<const uint16_t> table) noexcept {
+            m_dma_b.disable();
+            setup(m_dma_a, DMA::address_of(table.data()), static_cast<uint16_t>(table.size() * sizeof(uint16_t)), 0);
+            m_dma_a.enable();
+        }
+
+        /// stop feeding the DAC. The output holds the last value.
+        void stop() noexcept {
+            m_dma_a.disable();
+            m_dma_b.disable();
+        }
+
+        /// times both halves played out before service() refilled the first, so a half played its old samples again
+        [[nodiscard]] uint16_t underruns() const noexcept {
+            return m_underruns;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,224 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include <cstdint>
+
+namespace drivers {
+
+    namespace DMA {
+        using BURST_LENGTH = sfr::DMA::CH_BURSTLENv;
+        using SRC_RELOAD = sfr::DMA::CH_SRCRELOADv;
+        using SRC_MODE = sfr::DMA::CH_SRCDIRv;
+        using DEST_RELOAD = sfr::DMA::CH_DESTRELOADv;
+        using DEST_MODE = sfr::DMA::CH_DESTDIRv;
+        using TRIGGER = sfr::DMA::CH_TRIGSRCv;
+        using DOUBLE_BUFFER = sfr::DMA::DBUFMODEv;
+        using PRIORITY = sfr::DMA::PRIMODEv;
+        using ERR_INT_LVL = sfr::DMA::CH_ERRINTLVLv;
+        using TRN_INT_LVL = sfr::DMA::CH_TRNINTLVLv;
+
+        /// list of DMA errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            TIMEOUT = (1U<<7U),
+            TRANSFER_ERROR = (1U<<5U),
+            BUSY = (1U<<4U),
+            NONE = (1U<<0U)
+        };
+
+        /**
+         * The DMA controller addresses the data memory space with 24 bits. Internal SRAM and all of the
+         * peripheral registers live in the lower 64K, so on the AVR this is just the pointer value.
+         * In a simulation build the host pointer is truncated, since there is no DMA to consume it.
+         * @param p [IN] pointer to SRAM or a peripheral register
+         * @return the 24-bit data space address of p
+         */
+        inline uint32_t address_of(const volatile void* p) noexcept {
+            return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & 0x00FF'FFFFUL;
+        }
+
+        /// maximum number of bytes in a single block transfer. A TRFCNT of 0 means 64K.
+        inline constexpr uint32_t MAX_BLOCK_SIZE = 65'536UL;
+        /// maximum number of blocks in a repeated transfer. A REPCNT of 0 means repeat forever.
+        inline constexpr uint16_t MAX_REPEAT = 255U;
+
+    }   // namespace DMA
+
+    /**
+     * Zero overhead wrapper for the DMA controller itself. Controls the global enable, channel priority
+     * and the double buffering modes. Individual channels are handled with DMA_Channel_Basic.
+     */
+    template <typename DMA_INSTANCE>
+    class DMA_Controller_Basic {
+        DMA_INSTANCE m_instance;
+//        decltype(device::DMA) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr DMA_Controller_Basic(const DMA_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// enables the DMA controller with the given priority and double buffer setting
+        constexpr void start(const DMA::PRIORITY priority = DMA::PRIORITY::CH0123,
+                             const DMA::DOUBLE_BUFFER dbuf = DMA::DOUBLE_BUFFER::DISABLED) const noexcept {
+            m_instance.CTRL = m_instance.CTRL.ENABLE.shift(true)
+                            | m_instance.CTRL.DBUFMODE.shift(dbuf)
+                            | m_instance.CTRL.PRIMODE.shift(priority);
+        }
+
+        /// disables the DMA controller. Ongoing bursts are completed before the controller stops.
+        constexpr void stop() const noexcept {
+            m_instance.CTRL.ENABLE = false;
+        }
+
+        /// resets the controller and all channels to their initial state. Controller must be disabled.
+        constexpr void reset() const noexcept {
+            m_instance.CTRL.RESET = true;
+        }
+    };
+
+    /**
+     * Zero overhead driver for a single DMA channel. The instance is the channel member of the
+     * DMA controller, for example: drivers::DMA_Channel_Basic ch0(device::DMA.CH0);
+     */
+    template <typename DMA_CHANNEL>
+    class DMA_Channel_Basic {
+        DMA_CHANNEL m_instance;
+//        decltype(device::DMA.CH0) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        /// channel number 0-3. Channels are 16 bytes apart, starting 16 bytes after the controller.
+        static constexpr uint8_t index = ((DMA_CHANNEL::BaseAddress & 0x00F0U) >> 4U) - 1U;
+        static_assert(index < 4, "DMA channel must be one of the controller channels CH0-CH3");
+
+        constexpr DMA_Channel_Basic(const DMA_CHANNEL instance)
+            : m_instance(instance)
+        {}
+
+        /// configure the source address and addressing mode
+        constexpr void set_source(const uint32_t addr, const DMA::SRC_MODE mode, const DMA::SRC_RELOAD reload) const noexcept {
+            m_instance.SRCADDR0 = static_cast<uint8_t>(addr);
+            m_instance.SRCADDR1 = static_cast<uint8_t>(addr >> 8U);
+            m_instance.SRCADDR2 = static_cast<uint8_t>(addr >> 16U);
+            m_instance.ADDRCTRL.SRCDIR = mode;
+            m_instance.ADDRCTRL.SRCRELOAD = reload;
+        }
+
+        /// configure the destination address and addressing mode
+        constexpr void set_destination(const uint32_t addr, const DMA::DEST_MODE mode, const DMA::DEST_RELOAD reload) const noexcept {
+            m_instance.DESTADDR0 = static_cast<uint8_t>(addr);
+            m_instance.DESTADDR1 = static_cast<uint8_t>(addr >> 8U);
+            m_instance.DESTADDR2 = static_cast<uint8_t>(addr >> 16U);
+            m_instance.ADDRCTRL.DESTDIR = mode;
+            m_instance.ADDRCTRL.DESTRELOAD = reload;
+        }
+
+        /**
+         * Set the block size and number of blocks.
+         * @param block_size [IN] bytes in a block. 0 is interpreted by hardware as 64K.
+         * @param repeat [IN] number of blocks. 1 disables repeat mode, 0 repeats until the channel is disabled.
+         */
+        constexpr void set_count(const uint16_t block_size, const uint8_t repeat = 1) const noexcept {
+            m_instance.TRFCNT = block_size;
+            m_instance.REPCNT = repeat;
+            m_instance.CTRLA.REPEAT = (repeat != 1);
+        }
+
+        /**
+         * Configure how the channel is triggered.
+         * @param trig [IN] the trigger source, OFF for software triggers only
+         * @param burst [IN] bytes moved per burst
+         * @param single [IN] if true each trigger moves one burst, otherwise each trigger moves a whole block
+         */
+        constexpr void set_trigger(const DMA::TRIGGER trig, const DMA::BURST_LENGTH burst = DMA::BURST_LENGTH::_1BYTE, const bool single = false) const noexcept {
+            m_instance.TRIGSRC = static_cast<uint8_t>(trig);
+            m_instance.CTRLA.BURSTLEN = burst;
+            m_instance.CTRLA.SINGLE = single;
+        }
+
+        /// set the transaction complete and error interrupt levels for this channel
+        constexpr void enable_interrupt(const DMA::TRN_INT_LVL complete, const DMA::ERR_INT_LVL err = DMA::ERR_INT_LVL::OFF) const noexcept {
+            m_instance.CTRLB = m_instance.CTRLB.ERRINTLVL.shift(err) | m_instance.CTRLB.TRNINTLVL.shift(complete);
+        }
+
+        /// enables the channel. With a trigger source set it will wait for the trigger.
+        constexpr void enable() const noexcept {
+            m_instance.CTRLA.ENABLE = true;
+        }
+
+        /// disables the channel. The current burst is finished before the channel stops.
+        constexpr void disable() const noexcept {
+            m_instance.CTRLA.ENABLE = false;
+        }
+
+        /// reset the channel registers. Channel must be disabled.
+        constexpr void reset() const noexcept {
+            m_instance.CTRLA.RESET = true;
+        }
+
+        /// issue a software transfer request. The channel must be enabled.
+        constexpr void request() const noexcept {
+            m_instance.CTRLA.TRFREQ = true;
+        }
+
+        /// true while the channel is enabled and has not finished the transaction
+        [[nodiscard]] constexpr bool enabled() const noexcept {
+            return m_instance.CTRLA.ENABLE;
+        }
+
+        /// CTRLB read once, so the busy and flag bits are sampled together
+        [[nodiscard]] constexpr uint8_t status() const noexcept {
+            return m_instance.CTRLB.read();
+        }
+
+        /// true if a block transfer is ongoing or pending
+        [[nodiscard]] constexpr bool busy() const noexcept {
+            return status() & (m_instance.CTRLB.CHBUSY.mask | m_instance.CTRLB.CHPEND.mask);
+        }
+
+        /**
+         * Clear one of the flags, which are cleared by writing a one. A bitfield write would write back the
+         * other flag too and clear it as well, so the register is written with only this flag set. The
+         * interrupt levels share the register and are written back as they were.
+         */
+        constexpr void clear_flag(const uint8_t flag) const noexcept {
+            const uint8_t flags = m_instance.CTRLB.TRNIF.mask | m_instance.CTRLB.ERRIF.mask;
+            m_instance.CTRLB = static_cast<uint8_t>((status() & ~flags) | flag);
+        }
+
+        /// true if the transaction completed. Clears the flag if it was set.
+        [[nodiscard]] constexpr bool complete() const noexcept {
+            if(status() & m_instance.CTRLB.TRNIF.mask) {
+                clear_flag(m_instance.CTRLB.TRNIF.mask);
+                return true;
+            }
+            return false;
+        }
+
+        /// true if the transaction completed, without clearing the flag
+        [[nodiscard]] constexpr bool finished() const noexcept {
+            return status() & m_instance.CTRLB.TRNIF.mask;
+        }
+
+        /// true if a bus error occurred or the channel was enabled with bad settings. Clears the flag if it was set.
+        [[nodiscard]] constexpr bool error() const noexcept {
+            if(status() & m_instance.CTRLB.ERRIF.mask) {
+                clear_flag(m_instance.CTRLB.ERRIF.mask);
+                return true;
+            }
+            return false;
+        }
+
+        /// bytes remaining in the current block
+        [[nodiscard]] constexpr uint16_t remaining() const noexcept {
+            return m_instance.TRFCNT.read();
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
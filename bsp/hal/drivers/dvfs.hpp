@@ -0,0 +1,148 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/clk.hpp"      // clock trees and prescaler switching
+#include "drivers/cpu.hpp"      // the switch is atomic
+#include "drivers/spi.hpp"
+#include "drivers/twi.hpp"
+#include "drivers/uart.hpp"
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace drivers {
+
+    namespace DVFS {
+        /**
+         * Keeps a Uart_Basic at the same baud rate on every frequency step. The settings are solved at compile
+         * time for each step, so switching writes constants.
+         * example: drivers::DVFS::uart<decltype(board::EDBG_VCOM), 115'200>{ board::EDBG_VCOM }
+         */
+        template <typename DRIVER, uint32_t Baud, bool DoubleSpeed = false>
+        struct uart {
+            const DRIVER& driver;
+
+            template <uint32_t CpuFreq>
+            static constexpr uint16_t setting() noexcept {
+                static_assert(!USART::buad_too_high(CpuFreq, Baud, DoubleSpeed), "Baud rate is too high for a frequency step");
+                static_assert(!USART::buad_too_low(CpuFreq, Baud, DoubleSpeed), "Baud rate is too low for a frequency step");
+                return USART::get_baud(CpuFreq, Baud);
+            }
+
+            template <uint32_t CpuFreq>
+            void apply() const noexcept { driver.set_baud(setting<CpuFreq>()); }
+        };
+
+        /// keeps a TWI_Master_Basic at the same bus frequency on every frequency step
+        template <typename DRIVER, uint32_t Baud = 100'000, uint32_t TRise = 0>
+        struct twi {
+            const DRIVER& driver;
+
+            template <uint32_t CpuFreq>
+            static constexpr uint8_t setting() noexcept {
+                constexpr float baud = (static_cast<float>(CpuFreq) / Baud - 10.0F - static_cast<float>(CpuFreq) * TRise / 1'000'000.0F) / 2.0F;
+                static_assert(baud >= 0.0F && baud <= 255.0F, "TWI bus frequency can't be reached at a frequency step");
+                return TWI::get_baud(CpuFreq, Baud, TRise);
+            }
+
+            template <uint32_t CpuFreq>
+            void apply() const noexcept { driver.set_baud(setting<CpuFreq>()); }
+        };
+
+        /// keeps a SPI_Master_Basic below the same maximum clock on every frequency step
+        template <typename DRIVER, uint32_t MaxBaud>
+        struct spi {
+            const DRIVER& driver;
+
+            template <uint32_t CpuFreq>
+            static constexpr uint8_t setting() noexcept {
+                static_assert(MaxBaud > CpuFreq / 128U, "SPI clock can't get low enough at a frequency step");
+                return SPI::calculate_clock(CpuFreq, MaxBaud);
+            }
+
+            template <uint32_t CpuFreq>
+            void apply() const noexcept { driver.set_clock(setting<CpuFreq>()); }
+        };
+    }   // namespace DVFS
+
+    /**
+     * Frequency scaling between a fixed set of clock trees on the same source, for example a 32 MHz burst
+     * step and a 2 MHz idle step that only differ in prescaler A. The XMEGA has no voltage scaling, the gain
+     * is in the clock alone.
+     *
+     * set() changes the prescalers and rewrites the baud settings of the bound serial drivers in one critical
+     * section, so interrupts never see a driver running at the wrong rate. Every setting is a constant solved
+     * at compile time for each step; a step that a baud rate can't be reached at fails the build.
+     *
+     * Switch between transfers: a character or transaction in progress is corrupted, and the TWI master is
+     * restarted. Drivers not bound here must not depend on the CPU frequency, or the app re-solves them after
+     * a switch. Drivers started after a switch must be started with cpu_hz of the current step.
+     *
+     * example: drivers::FrequencyScaler<decltype(device::CLK), board::SystemClock, board::IdleClock> dvfs(device::CLK);
+     *          const drivers::DVFS::uart<decltype(board::EDBG_VCOM), 115'200> vcom{ board::EDBG_VCOM };
+     *          dvfs.set<1>(vcom);  ...  dvfs.set<0>(vcom);
+     * @tparam STEPS clock trees from CLK::tree, all on the same source
+     */
+    template <typename CLK_INSTANCE, typename... STEPS>
+    class FrequencyScaler {
+        static_assert(sizeof...(STEPS) > 0, "At least one frequency step is needed");
+        using FIRST = std::tuple_element_t<0, std::tuple<STEPS...>>;
+        static_assert(((STEPS::source == FIRST::source && STEPS::system_hz == FIRST::system_hz) && ...),
+                      "All frequency steps must run from the same source at the same frequency, only the prescalers change");
+
+        CLK_Basic<CLK_INSTANCE> m_clk;
+        uint8_t m_step = 0;
+
+        template <uint8_t STEP, typename... BINDINGS>
+        void apply(const BINDINGS&... bindings) noexcept {
+            using TREE = std::tuple_element_t<STEP, std::tuple<STEPS...>>;
+            m_clk.set_system_clock(TREE::source, TREE::prescale_a, TREE::prescale_b_c);
+            (bindings.template apply<TREE::cpu_hz>(), ...);
+            m_step = STEP;
+        }
+
+        template <typename... BINDINGS, size_t... I>
+        void apply_runtime(const uint8_t step, std::index_sequence<I...>, const BINDINGS&... bindings) noexcept {
+            ((step == I ? apply<I>(bindings...) : void()), ...);
+        }
+
+    public:
+        /// CPU frequency of each step
+        static constexpr std::array<uint32_t, sizeof...(STEPS)> cpu_hz_table = { STEPS::cpu_hz... };
+
+        /// the scaler assumes the clock system starts in step 0, set up by the board
+        constexpr FrequencyScaler(const CLK_INSTANCE clk)
+            : m_clk(clk)
+        {}
+
+        /// switch to a step and retune the bound drivers, see DVFS::uart, DVFS::twi and DVFS::spi
+        template <uint8_t STEP, typename... BINDINGS>
+        void set(const BINDINGS&... bindings) noexcept {
+            static_assert(STEP < sizeof...(STEPS), "There is no such frequency step");
+            CPU::critical_section lock;
+            apply<STEP>(bindings...);
+        }
+
+        /// switch to a step chosen at run time. Each step's settings are still compile time constants.
+        template <typename... BINDINGS>
+        void set(const uint8_t step, const BINDINGS&... bindings) noexcept {
+            if(step >= sizeof...(STEPS)) { return; }
+            CPU::critical_section lock;
+            apply_runtime(step, std::make_index_sequence<sizeof...(STEPS)>{}, bindings...);
+        }
+
+        [[nodiscard]] uint8_t step() const noexcept { return m_step; }
+
+        /// CPU frequency of the current step
+        [[nodiscard]] uint32_t cpu_hz() const noexcept { return cpu_hz_table[m_step]; }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
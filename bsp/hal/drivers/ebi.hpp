@@ -0,0 +1,250 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#if !(defined(__AVR_ATxmega128A1U__) || defined(__atxmega128a1u__))
+#   error "The EBI is only on the ATxmega128A1U, there is no external bus interface on this processor"
+#endif
+
+#include "device.hpp"               // need this to forward the enum definitions
+#include "drivers/power.hpp"        // the EBI is gated until started
+#include "nonstd/allocator.hpp"     // arena over the external memory
+#include "nonstd/expected.hpp"      // std::expected implementation for safe return value
+#include <cstddef>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace EBI {
+        using INTERFACE = sfr::EBI::IFMODEv;
+        using SRAM_MODE = sfr::EBI::SRMODEv;
+        using LPC_MODE = sfr::EBI::LPCMODEv;
+        using ADDRESS_SIZE = sfr::EBI::CS_ASIZEv;
+        using WAIT_STATES = sfr::EBI::CS_SRWSv;
+        using SDRAM_WIDTH = sfr::EBI::SDDATAWv;
+        using SDRAM_COLUMNS = sfr::EBI::SDCOLv;
+        using MODE_DELAY = sfr::EBI::MRDLYv;
+        using ROW_CYCLE_DELAY = sfr::EBI::ROWCYCDLYv;
+        using ROW_PRECHARGE_DELAY = sfr::EBI::RPDLYv;
+        using WRITE_RECOVERY_DELAY = sfr::EBI::WRDLYv;
+        using SELF_REFRESH_DELAY = sfr::EBI::ESRDLYv;
+        using ROW_COLUMN_DELAY = sfr::EBI::ROWCOLDLYv;
+
+        /// list of EBI errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            TIMEOUT = (1U<<7U),
+            NONE = (1U<<0U)
+        };
+
+        /// first data address after the internal SRAM of the A1U, external memory can start here
+        inline constexpr uint32_t EXTERNAL_START = 0x4000UL;
+        /// end of the 16-bit data space. Memory above it is only reached with RAMPX/Y/Z/D or by the DMA.
+        inline constexpr uint32_t DIRECT_END = 0x1'0000UL;
+        /// SDRAM is only supported on chip select 3
+        inline constexpr uint8_t SDRAM_CS = 3;
+        /// polls of SDINITDONE before the SDRAM initialization is given up
+        inline constexpr uint32_t INIT_LOOPS = 100'000UL;
+
+        /// bytes covered by a chip select address size
+        constexpr uint32_t size_bytes(const ADDRESS_SIZE size) noexcept {
+            return 256UL << static_cast<uint8_t>(size);
+        }
+
+        /// SDRAM refresh period in clkPER2 cycles for a row refresh interval, 64 ms / 4096 rows by default
+        template <uint32_t Per2Hz, uint32_t RowRefreshNs = 15'625UL>
+        constexpr uint16_t refresh_period() noexcept {
+            constexpr uint64_t cycles = static_cast<uint64_t>(Per2Hz) * RowRefreshNs / 1'000'000'000ULL;
+            static_assert(cycles > 0 && cycles < 0x400U, "The SDRAM refresh period must fit in 10 bits");
+            return static_cast<uint16_t>(cycles);
+        }
+
+        /// SDRAM power up delay in clkPER2 cycles, 100 us by default
+        template <uint32_t Per2Hz, uint32_t DelayUs = 100>
+        constexpr uint16_t init_delay() noexcept {
+            constexpr uint64_t cycles = (static_cast<uint64_t>(Per2Hz) * DelayUs + 999'999ULL) / 1'000'000ULL;
+            static_assert(cycles < 0x4000U, "The SDRAM initialization delay must fit in 14 bits");
+            return static_cast<uint16_t>(cycles);
+        }
+
+        /// SDRAM geometry and timing, the delays in clkPER2 cycles from the memory's data sheet
+        struct sdram_config {
+            SDRAM_COLUMNS columns;
+            bool rows_12bit;                        // 12 row bits, else 11
+            bool cas_3;                             // CAS latency 3, else 2
+            uint16_t refresh;                       // see refresh_period()
+            uint16_t init_delay;                    // see init_delay()
+            MODE_DELAY mode_delay;
+            ROW_CYCLE_DELAY row_cycle;
+            ROW_PRECHARGE_DELAY row_precharge;
+            WRITE_RECOVERY_DELAY write_recovery;
+            SELF_REFRESH_DELAY exit_self_refresh;
+            ROW_COLUMN_DELAY row_column;
+        };
+    }   // namespace EBI
+
+    /**
+     * Zero overhead driver for the external bus interface of the A1U, for example:
+     * drivers::EBI_Basic ebi(device::EBI);
+     *
+     * The EBI maps external SRAM or SDRAM into the data space, where it is read and written like internal
+     * SRAM with a few extra cycles per access. Each of the four chip selects covers an aligned block of
+     * 256 bytes to 16 MB; chip select 3 can also drive SDRAM. A block may start at 0 and overlap the internal
+     * memories, which take precedence, so a 64K SRAM at base 0 is reached from EBI::EXTERNAL_START up.
+     * Memory from EBI::EXTERNAL_START to 64K is reached with plain pointers, see ExternalArena.
+     *
+     * Resources: ports H and K for control and address lines, and port J for data. start() makes the control
+     * and address lines outputs with the strobes and chip selects inactive; the EBI drives the data lines.
+     */
+    template <typename EBI_INSTANCE>
+    class EBI_Basic {
+        EBI_INSTANCE m_instance;
+//        decltype(device::EBI) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        template <uint8_t CS>
+        using CS_INSTANCE = sfr::EBI_CS_t<EBI_INSTANCE::BaseAddress + 0x10U + 4U * CS>;
+
+        template <uint8_t CS, uint32_t Base, EBI::ADDRESS_SIZE Size>
+        static constexpr void check_block() noexcept {
+            static_assert(CS < 4, "The EBI has chip selects 0-3");
+            static_assert(Base % EBI::size_bytes(Size) == 0 && Base % 0x1000UL == 0,
+                          "A chip select block must be aligned to its size, and to 4K");
+            static_assert(Base + EBI::size_bytes(Size) <= 0x100'0000UL, "A chip select block can't go past 16M");
+            static_assert(Base + EBI::size_bytes(Size) > EBI::EXTERNAL_START,
+                          "A chip select block entirely under internal memory can never be reached");
+        }
+
+        template <uint8_t CS, uint32_t Base, EBI::ADDRESS_SIZE Size>
+        static void set_block(const sfr::EBI::CS_MODEv mode) noexcept {
+            CS_INSTANCE<CS>::BASEADDR = static_cast<uint16_t>((Base >> 8U) & 0xFFF0U);
+            CS_INSTANCE<CS>::CTRLA = CS_INSTANCE<CS>::CTRLA.ASIZE.shift(Size) | CS_INSTANCE<CS>::CTRLA.MODE.shift(mode);
+        }
+
+    public:
+        constexpr EBI_Basic(const EBI_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /**
+         * Turn on the interface and its pins. Chip selects are enabled afterwards.
+         * @param mode [IN] 2, 3 or 4 port interface
+         * @param sram [IN] address latch use in SRAM mode
+         * @param lpc [IN] address latch use in SRAM LPC mode
+         * @param width [IN] SDRAM data bus width, 4 bits in 3 port mode
+         */
+        void start(const EBI::INTERFACE mode, const EBI::SRAM_MODE sram = EBI::SRAM_MODE::NOALE,
+                   const EBI::LPC_MODE lpc = EBI::LPC_MODE::ALE1, const EBI::SDRAM_WIDTH width = EBI::SDRAM_WIDTH::_4BIT) const noexcept {
+            POWER::enable<EBI_INSTANCE>();
+            // WE, RE and the chip selects are active low
+            decltype(device::PORTH)::OUTSET = 0xF3U;
+            decltype(device::PORTH)::DIRSET = 0xFFU;
+            decltype(device::PORTK)::DIRSET = 0xFFU;
+            m_instance.CTRL = m_instance.CTRL.SDDATAW.shift(width)
+                            | m_instance.CTRL.LPCMODE.shift(lpc)
+                            | m_instance.CTRL.SRMODE.shift(sram)
+                            | m_instance.CTRL.IFMODE.shift(mode);
+        }
+
+        /// disable every chip select and the interface, and gate the clock
+        void stop() const noexcept {
+            disable<0>();
+            disable<1>();
+            disable<2>();
+            disable<3>();
+            m_instance.CTRL = 0;
+            POWER::disable<EBI_INSTANCE>();
+        }
+
+        /**
+         * Map an SRAM to a block of the data space.
+         * @tparam Base first data address of the block, aligned to its size. Internal memory hides any part
+         *              of the block below EBI::EXTERNAL_START.
+         * @param wait [IN] extra clkPER2 cycles per access for slow memories
+         * @param lpc [IN] low pin count mode, data multiplexed with the address
+         */
+        template <uint8_t CS, uint32_t Base, EBI::ADDRESS_SIZE Size>
+        void enable_sram(const EBI::WAIT_STATES wait = EBI::WAIT_STATES::_0CLK, const bool lpc = false) const noexcept {
+            check_block<CS, Base, Size>();
+            CS_INSTANCE<CS>::CTRLB.SRWS = wait;
+            set_block<CS, Base, Size>(lpc ? sfr::EBI::CS_MODEv::LPC : sfr::EBI::CS_MODEv::SRAM);
+        }
+
+        /**
+         * Map an SDRAM to a block of the data space on chip select 3 and wait for its initialization
+         * sequence, which runs in hardware and keeps refreshing afterwards.
+         * @param config [IN] geometry and timing of the memory
+         * @return TIMEOUT if the EBI never reported the initialization done
+         */
+        template <uint32_t Base, EBI::ADDRESS_SIZE Size>
+        [[nodiscard]] nonstd::expected<void, EBI::error> enable_sdram(const EBI::sdram_config& config) const noexcept {
+            check_block<EBI::SDRAM_CS, Base, Size>();
+            m_instance.SDRAMCTRLA = m_instance.SDRAMCTRLA.SDCAS.shift(config.cas_3)
+                                  | m_instance.SDRAMCTRLA.SDROW.shift(config.rows_12bit)
+                                  | m_instance.SDRAMCTRLA.SDCOL.shift(config.columns);
+            m_instance.REFRESH = config.refresh;
+            m_instance.INITDLY = config.init_delay;
+            m_instance.SDRAMCTRLB = m_instance.SDRAMCTRLB.MRDLY.shift(config.mode_delay)
+                                  | m_instance.SDRAMCTRLB.ROWCYCDLY.shift(config.row_cycle)
+                                  | m_instance.SDRAMCTRLB.RPDLY.shift(config.row_precharge);
+            m_instance.SDRAMCTRLC = m_instance.SDRAMCTRLC.WRDLY.shift(config.write_recovery)
+                                  | m_instance.SDRAMCTRLC.ESRDLY.shift(config.exit_self_refresh)
+                                  | m_instance.SDRAMCTRLC.ROWCOLDLY.shift(config.row_column);
+            set_block<EBI::SDRAM_CS, Base, Size>(sfr::EBI::CS_MODEv::SDRAM);
+            using CS3 = CS_INSTANCE<EBI::SDRAM_CS>;
+            for(uint32_t i = 0; i < EBI::INIT_LOOPS; ++i) {
+                if(CS3::CTRLB.read() & CS3::CTRLB.SDINITDONE.mask) { return {}; }
+            }
+            return nonstd::make_unexpected(EBI::error::TIMEOUT);
+        }
+
+        /// let the SDRAM refresh itself, so it keeps its contents while the EBI is idle or the CPU sleeps
+        void sdram_self_refresh(const bool enable) const noexcept {
+            CS_INSTANCE<EBI::SDRAM_CS>::CTRLB.SDSREN = enable;
+        }
+
+        /// unmap a chip select, its pin goes inactive
+        template <uint8_t CS>
+        void disable() const noexcept {
+            static_assert(CS < 4, "The EBI has chip selects 0-3");
+            CS_INSTANCE<CS>::CTRLA.MODE = sfr::EBI::CS_MODEv::DISABLED;
+        }
+    };
+
+    namespace EBI {
+        /// arena storage at a fixed data address in external memory, or a host array in a simulation build
+        template <uint32_t BASE, uint32_t SIZE>
+        struct external_storage {
+            static_assert(BASE >= EXTERNAL_START && SIZE > 0 && BASE + SIZE <= DIRECT_END,
+                          "The arena must be in external memory below 64K, where pointers reach it");
+#if SIMULATION_BUILD
+            alignas(std::max_align_t) static inline uint8_t s_memory[SIZE] = {};
+            [[nodiscard]] static uint8_t* data() noexcept { return s_memory; }
+#else
+            [[nodiscard]] static uint8_t* data() noexcept { return reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(BASE)); }
+#endif
+        };
+    }   // namespace EBI
+
+    /**
+     * Arena over external memory mapped by EBI_Basic, for the large buffers that are touched once per batch:
+     * sample histories, DMA rings, log pages. Everything declared the normal way stays in internal SRAM, so
+     * hot data keeps single cycle access and only these buffers pay the EBI wait states. See nonstd::arena.
+     *
+     * The arena must lie below 64K so plain pointers reach it. In a simulation build it is backed by a host
+     * array of the same size, so the code using it runs unchanged.
+     *
+     * example: drivers::ExternalArena<0x4000, 0xC000> xram;     // the upper 48K of a 64K SRAM mapped at 0
+     *          ebi.start(drivers::EBI::INTERFACE::_3PORT);
+     *          ebi.enable_sram<0, 0x0000, drivers::EBI::ADDRESS_SIZE::_64KB>();
+     *          const auto history = xram.allocate<peripheral::accel::Acceleration>(2048);
+     */
+    template <uint32_t BASE, uint32_t SIZE, typename LOCK = nonstd::alloc::no_lock, bool TRACK = false>
+    using ExternalArena = nonstd::arena<SIZE, LOCK, TRACK, EBI::external_storage<BASE, SIZE>>;
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,417 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/nvm.hpp"         // EEPROM page buffer access
+#include "nonstd/crc.hpp"          // per record integrity check
+#include "nonstd/expected.hpp"     // std::expected implementation for safe return value
+#include "nonstd/span.hpp"         // span for non-owning range based read/write functions
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace drivers {
+
+    namespace EEPROM_KV {
+        /// list of key-value store errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            NOT_FOUND = (1U<<7U),
+            BAD_KEY = (1U<<6U),
+            TOO_LARGE = (1U<<5U),
+            FULL = (1U<<4U),
+            NVM_ERROR = (1U<<3U),
+            NONE = (1U<<0U)
+        };
+
+        /// page header: sequence number (little endian) and its CRC
+        inline constexpr uint8_t HEADER_SIZE = 3;
+        /// record framing: key, length, and a CRC after the value
+        inline constexpr uint8_t RECORD_OVERHEAD = 3;
+        /// largest value that fits in a record. Records never span pages.
+        inline constexpr uint8_t MAX_VALUE_SIZE = NVM::EEPROM_PAGE_SIZE - HEADER_SIZE - RECORD_OVERHEAD;
+        /// an erased byte, also marks the end of the records in a page
+        inline constexpr uint8_t ERASED = 0xFF;
+    }
+
+    /**
+     * Wear leveled, power fail safe key-value store in a range of EEPROM pages.
+     *
+     * The pages form a circular log. Every put() appends a record (key, length, value, CRC-8) to the head
+     * page with a write-only page command of just the record bytes, so an update costs one partial page
+     * write and no erase. A put() with the value already stored writes nothing. A put() with an empty value
+     * appends a tombstone and removes the key.
+     *
+     * Each page starts with a header holding a sequence number. The page after the head is always kept
+     * erased. When the head is full the log moves into that page, the live records of the oldest page (the
+     * one after the new head) are copied forward, and the oldest page is erased in the background to become
+     * the next spare. Every page is erased once per trip around the log, which spreads the wear evenly.
+     *
+     * start() scans the region and builds the RAM index from the oldest page to the newest, so the newest
+     * copy of a key wins and get() is a single table lookup. A record torn by a power failure fails its CRC
+     * and is ignored; the rest of that page is left unused. If power fails while copying the oldest page,
+     * both copies are found and start() finishes the copy and the erase. If the failure tore a record of
+     * the copy, the head holds nothing but copies of records still in the oldest page, so start() erases
+     * the head and the copy is done again into the freshly erased page on the next advance. A header is
+     * only ever written to a blank page.
+     *
+     * Keep the live data below (PAGES - 2) pages so there is always room to compact.
+     *
+     * Resources: 2 bytes of RAM per key for the index and 6 bytes of state. Reads wait for the NVM
+     * controller; writes and erases are started and left running, so the caller does not wait on them.
+     * The NVM interrupts are not used by this store.
+     *
+     * example: drivers::EEPROM_KV_Store<decltype(device::NVM), 0, 16, 32> config(device::NVM);
+     * @tparam FIRST_PAGE first EEPROM page used by the store
+     * @tparam PAGES number of EEPROM pages used by the store
+     * @tparam KEYS keys are 0 to KEYS-1
+     */
+    template <typename NVM_INSTANCE, uint16_t FIRST_PAGE, uint16_t PAGES, uint8_t KEYS>
+    class EEPROM_KV_Store {
+        static_assert(PAGES >= 3, "The key-value store needs a head, a spare and at least one page to compact");
+        static_assert(FIRST_PAGE + PAGES <= NVM::EEPROM_PAGES, "The key-value store does not fit in the EEPROM");
+        static_assert(KEYS > 0 && KEYS < EEPROM_KV::ERASED, "Key 0xFF marks erased EEPROM and can't be used");
+
+        static constexpr uint8_t PAGE_SIZE = NVM::EEPROM_PAGE_SIZE;
+        static constexpr uint16_t CAPACITY = (PAGES - 2U) * (PAGE_SIZE - EEPROM_KV::HEADER_SIZE);
+        /// index value for a key with no record. Address 0 is always a page header in the store.
+        static constexpr uint16_t NO_RECORD = 0;
+
+        NVM_Basic<NVM_INSTANCE> m_nvm;
+        std::array<uint16_t, KEYS> m_index{};   // EEPROM address of the newest record for each key
+        uint16_t m_sequence = 0;                // sequence number of the head page
+        uint16_t m_live = 0;                    // bytes used by live records
+        uint8_t m_head = 0;                     // head page, relative to FIRST_PAGE
+        uint8_t m_offset = PAGE_SIZE;           // next free byte in the head page
+
+        static constexpr uint16_t page_address(const uint8_t page) noexcept {
+            return (FIRST_PAGE + page) * PAGE_SIZE;
+        }
+
+        static constexpr uint8_t next(const uint8_t page) noexcept {
+            return (page + 1U) % PAGES;
+        }
+
+        /// length byte of the record at addr
+        [[nodiscard]] uint8_t length(const uint16_t addr) const noexcept {
+            return m_nvm.eeprom_read(addr + 1U);
+        }
+
+        [[nodiscard]] bool blank(const uint8_t page) const noexcept {
+            const uint16_t addr = page_address(page);
+            for(uint8_t i = 0; i < PAGE_SIZE; ++i) {
+                if(m_nvm.eeprom_read(addr + i) != EEPROM_KV::ERASED) { return false; }
+            }
+            return true;
+        }
+
+        /// the sequence number of a page, if it has a valid header
+        [[nodiscard]] nonstd::expected<uint16_t, EEPROM_KV::error> header(const uint8_t page) const noexcept {
+            const uint16_t addr = page_address(page);
+            const std::array<uint8_t, 2> seq{ m_nvm.eeprom_read(addr), m_nvm.eeprom_read(addr + 1U) };
+            const uint8_t crc = m_nvm.eeprom_read(addr + 2U);
+            if((seq[0] & seq[1] & crc) == EEPROM_KV::ERASED || nonstd::crc8(seq) != crc) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NOT_FOUND);
+            }
+            return static_cast<uint16_t>(seq[0] | (seq[1] << 8U));
+        }
+
+        /**
+         * Check the record at offset in a page.
+         * @return the record size, 0 at the end of the records, or an error for a torn or corrupt record
+         */
+        [[nodiscard]] nonstd::expected<uint8_t, EEPROM_KV::error> check(const uint8_t page, const uint8_t offset) const noexcept {
+            const uint16_t addr = page_address(page) + offset;
+            const uint8_t key = m_nvm.eeprom_read(addr);
+            if(key == EEPROM_KV::ERASED) { return 0; }
+            const uint8_t len = length(addr);
+            const uint8_t size = len + EEPROM_KV::RECORD_OVERHEAD;
+            if(len > EEPROM_KV::MAX_VALUE_SIZE || offset + size > PAGE_SIZE) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NOT_FOUND);
+            }
+            uint8_t crc = 0xFF;
+            for(uint8_t i = 0; i < size - 1U; ++i) {
+                crc = nonstd::crc8_update(crc, m_nvm.eeprom_read(addr + i));
+            }
+            if(crc != m_nvm.eeprom_read(addr + size - 1U)) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NOT_FOUND);
+            }
+            return size;
+        }
+
+        /// point the index at a record, or drop the key for a tombstone, and keep the live byte count
+        void index(const uint8_t key, const uint16_t addr, const uint8_t len) noexcept {
+            if(key >= KEYS) { return; }
+            if(m_index[key] != NO_RECORD) {
+                m_live -= length(m_index[key]) + EEPROM_KV::RECORD_OVERHEAD;
+            }
+            m_index[key] = len ? addr : NO_RECORD;
+            if(len) {
+                m_live += len + EEPROM_KV::RECORD_OVERHEAD;
+            }
+        }
+
+        /// add the records of a page to the index. Returns the end of the usable part of the page.
+        uint8_t replay(const uint8_t page) noexcept {
+            uint8_t offset = EEPROM_KV::HEADER_SIZE;
+            while(offset < PAGE_SIZE) {
+                const auto size = check(page, offset);
+                if(!size) { return PAGE_SIZE; }     // torn record, nothing after it can be trusted
+                if(size.value() == 0) { break; }
+                const uint16_t addr = page_address(page) + offset;
+                index(m_nvm.eeprom_read(addr), addr, length(addr));
+                offset += size.value();
+            }
+            return offset;
+        }
+
+        /// write a record to the head page. The caller checks that it fits.
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error>
+        append(const uint8_t key, nonstd::span<const uint8_t> value) noexcept {
+            m_nvm.eeprom_flush_buffer();
+            const uint16_t addr = page_address(m_head) + m_offset;
+            const uint8_t len = value.size();
+            uint8_t crc = nonstd::crc8_update(nonstd::crc8_update(0xFF, key), len);
+            crc = nonstd::crc8(value, crc);
+            m_nvm.eeprom_load(addr, key);
+            m_nvm.eeprom_load(addr + 1U, len);
+            uint16_t a = addr + 2U;
+            for(const uint8_t d : value) {
+                m_nvm.eeprom_load(a++, d);
+            }
+            m_nvm.eeprom_load(a, crc);
+            index(key, addr, len);  // reads the old record, so it's done before the write starts
+            m_offset += len + EEPROM_KV::RECORD_OVERHEAD;
+            if(!m_nvm.start_eeprom_write(FIRST_PAGE + m_head, NVM::EE_INT_LVL::OFF)) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NVM_ERROR);
+            }
+            return true;
+        }
+
+        /// copy the live records of a page to the head, then start erasing it
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> reclaim(const uint8_t page) noexcept {
+            m_nvm.wait();
+            if(blank(page)) { return true; }
+            if(header(page)) {
+                uint8_t offset = EEPROM_KV::HEADER_SIZE;
+                while(offset < PAGE_SIZE) {
+                    const auto size = check(page, offset);
+                    if(!size || size.value() == 0) { break; }
+                    const uint16_t addr = page_address(page) + offset;
+                    const uint8_t key = m_nvm.eeprom_read(addr);
+                    if(key < KEYS && m_index[key] == addr) {
+                        if(m_offset + size.value() > PAGE_SIZE) {
+                            return nonstd::make_unexpected(EEPROM_KV::error::FULL);
+                        }
+                        std::array<uint8_t, EEPROM_KV::MAX_VALUE_SIZE> value;
+                        const uint8_t len = length(addr);
+                        for(uint8_t i = 0; i < len; ++i) {
+                            value[i] = m_nvm.eeprom_read(addr + 2U + i);
+                        }
+                        const auto r = append(key, {value.data(), len});
+                        if(!r) { return r; }
+                    }
+                    offset += size.value();
+                }
+            }
+            m_nvm.eeprom_flush_buffer();
+            if(!m_nvm.start_eeprom_erase(FIRST_PAGE + page, NVM::EE_INT_LVL::OFF)) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NVM_ERROR);
+            }
+            return true;
+        }
+
+        /**
+         * Write a page header to the erased page after the head and make it the head. A page that isn't
+         * blank still holds records that could not be copied out of it, so it is left alone.
+         */
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> open_page(const uint16_t sequence) noexcept {
+            const uint8_t page = next(m_head);
+            const uint16_t addr = page_address(page);
+            m_nvm.wait();
+            if(!blank(page)) { return nonstd::make_unexpected(EEPROM_KV::error::FULL); }
+            const std::array<uint8_t, 2> seq{ static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8U) };
+            m_nvm.eeprom_flush_buffer();
+            m_nvm.eeprom_load(addr, seq[0]);
+            m_nvm.eeprom_load(addr + 1U, seq[1]);
+            m_nvm.eeprom_load(addr + 2U, nonstd::crc8(seq));
+            if(!m_nvm.start_eeprom_write(FIRST_PAGE + page, NVM::EE_INT_LVL::OFF)) {
+                return nonstd::make_unexpected(EEPROM_KV::error::NVM_ERROR);
+            }
+            m_head = page;
+            m_offset = EEPROM_KV::HEADER_SIZE;
+            m_sequence = sequence;
+            return true;
+        }
+
+        /// move the head into the spare page and compact the oldest page into it
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> advance() noexcept {
+            // finish a compaction that an earlier call couldn't, so the spare is blank
+            const auto spare = reclaim(next(m_head));
+            if(!spare) { return spare; }
+            const auto r = open_page(m_sequence + 1U);
+            if(!r) { return r; }
+            return reclaim(next(m_head));
+        }
+
+    public:
+        constexpr EEPROM_KV_Store(const NVM_INSTANCE instance)
+            : m_nvm(instance)
+        {}
+
+        /**
+         * Enable the EEPROM, rebuild the index from the log and finish any compaction interrupted by a
+         * power failure. Formats the region if it holds no log. Blocks until the EEPROM is ready.
+         */
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> start() noexcept {
+            m_nvm.start();
+            m_nvm.wait();
+            m_index.fill(NO_RECORD);
+            m_live = 0;
+
+            // the head is the page with the newest sequence number
+            bool found = false;
+            for(uint8_t page = 0; page < PAGES; ++page) {
+                const auto seq = header(page);
+                if(seq && (!found || static_cast<int16_t>(seq.value() - m_sequence) > 0)) {
+                    m_head = page;
+                    m_sequence = seq.value();
+                    found = true;
+                }
+            }
+            if(!found) { return format(); }
+
+            // replay from the oldest page to the head. Pages are opened in order, so the page i places
+            // after the head was opened PAGES - i sequence numbers ago.
+            for(uint8_t i = 1; i <= PAGES; ++i) {
+                const uint8_t page = (m_head + i) % PAGES;
+                const auto seq = header(page);
+                if(seq && seq.value() == static_cast<uint16_t>(m_sequence - (PAGES - i))) {
+                    m_offset = replay(page);
+                }
+            }
+
+            // A torn or full head with the oldest page not erased yet means power failed while copying into
+            // the head, and the copy can't go on there. Appends wait for that erase, so the head holds copies
+            // and nothing else: erase it and start over. The previous page is the head again, with this one
+            // as its spare.
+            if(m_offset == PAGE_SIZE && !blank(next(m_head))) {
+                m_nvm.eeprom_flush_buffer();
+                if(!m_nvm.start_eeprom_erase(FIRST_PAGE + m_head, NVM::EE_INT_LVL::OFF)) {
+                    return nonstd::make_unexpected(EEPROM_KV::error::NVM_ERROR);
+                }
+                m_nvm.wait();
+                return start();
+            }
+            return reclaim(next(m_head));
+        }
+
+        /// erase the whole region and start an empty log. Blocks until the EEPROM is ready.
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> format() noexcept {
+            for(uint8_t page = 0; page < PAGES; ++page) {
+                m_nvm.eeprom_flush_buffer();
+                if(!m_nvm.start_eeprom_erase(FIRST_PAGE + page, NVM::EE_INT_LVL::OFF)) {
+                    return nonstd::make_unexpected(EEPROM_KV::error::NVM_ERROR);
+                }
+            }
+            m_index.fill(NO_RECORD);
+            m_live = 0;
+            m_head = PAGES - 1U;
+            return open_page(0);
+        }
+
+        /// true if a value is stored for key
+        [[nodiscard]] constexpr bool contains(const uint8_t key) const noexcept {
+            return key < KEYS && m_index[key] != NO_RECORD;
+        }
+
+        /// bytes of live data, out of capacity()
+        [[nodiscard]] constexpr uint16_t used() const noexcept { return m_live; }
+
+        /// bytes available for live records, including their framing
+        [[nodiscard]] static constexpr uint16_t capacity() noexcept { return CAPACITY; }
+
+        /**
+         * Read the value stored for key.
+         * @param buffer [OUT] receives the value, must be large enough for it
+         * @return size of the value, or an error
+         */
+        [[nodiscard]] nonstd::expected<uint8_t, EEPROM_KV::error>
+        get(const uint8_t key, nonstd::span<uint8_t> buffer) const noexcept {
+            if(!contains(key)) { return nonstd::make_unexpected(EEPROM_KV::error::NOT_FOUND); }
+            m_nvm.wait();
+            const uint16_t addr = m_index[key];
+            const uint8_t len = length(addr);
+            if(len > buffer.size()) { return nonstd::make_unexpected(EEPROM_KV::error::TOO_LARGE); }
+            for(uint8_t i = 0; i < len; ++i) {
+                buffer[i] = m_nvm.eeprom_read(addr + 2U + i);
+            }
+            return len;
+        }
+
+        /**
+         * Store a value for key. Nothing is written if the stored value is the same.
+         * @param value [IN] up to EEPROM_KV::MAX_VALUE_SIZE bytes. An empty value removes the key.
+         */
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error>
+        put(const uint8_t key, nonstd::span<const uint8_t> value) noexcept {
+            if(key >= KEYS) { return nonstd::make_unexpected(EEPROM_KV::error::BAD_KEY); }
+            if(value.size() > EEPROM_KV::MAX_VALUE_SIZE) { return nonstd::make_unexpected(EEPROM_KV::error::TOO_LARGE); }
+            m_nvm.wait();
+
+            const uint16_t old = m_index[key];
+            const uint8_t old_size = (old != NO_RECORD) ? length(old) + EEPROM_KV::RECORD_OVERHEAD : 0;
+            if(old == NO_RECORD && value.empty()) { return true; }
+            if(old != NO_RECORD && length(old) == value.size()) {
+                bool same = true;
+                for(uint8_t i = 0; i < value.size() && same; ++i) {
+                    same = m_nvm.eeprom_read(old + 2U + i) == value[i];
+                }
+                if(same) { return true; }
+            }
+
+            const uint8_t size = value.size() + EEPROM_KV::RECORD_OVERHEAD;
+            if(m_live - old_size + (value.empty() ? 0 : size) > CAPACITY) {
+                return nonstd::make_unexpected(EEPROM_KV::error::FULL);
+            }
+            // each advance frees at least the dead records of one page, so a full lap is enough
+            for(uint8_t lap = 0; m_offset + size > PAGE_SIZE; ++lap) {
+                if(lap == PAGES) { return nonstd::make_unexpected(EEPROM_KV::error::FULL); }
+                const auto r = advance();
+                if(!r) { return r; }
+            }
+            return append(key, value);
+        }
+
+        /// remove key from the store
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> remove(const uint8_t key) noexcept {
+            return put(key, {});
+        }
+
+        /// store a trivially copyable value
+        template <typename T>
+        [[nodiscard]] nonstd::expected<bool, EEPROM_KV::error> put(const uint8_t key, const T& value) noexcept {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be stored");
+            static_assert(sizeof(T) <= EEPROM_KV::MAX_VALUE_SIZE, "Type is too large for a key-value record");
+            return put(key, nonstd::span<const uint8_t>{reinterpret_cast<const uint8_t*>(&value), sizeof(T)});
+        }
+
+        /// read a trivially copyable value. The stored size must match the type.
+        template <typename T>
+        [[nodiscard]] nonstd::expected<T, EEPROM_KV::error> get(const uint8_t key) const noexcept {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be stored");
+            T value;
+            const auto r = get(key, nonstd::span<uint8_t>{reinterpret_cast<uint8_t*>(&value), sizeof(T)});
+            if(!r) { return nonstd::make_unexpected(r.error()); }
+            if(r.value() != sizeof(T)) { return nonstd::make_unexpected(EEPROM_KV::error::NOT_FOUND); }
+            return value;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,306 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include "pin_types.hpp"    // for pin event sources
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace drivers {
+
+    namespace EVSYS {
+        using SOURCE = sfr::EVSYS::CHMUXv;
+        using FILTER = sfr::EVSYS::DIGFILTv;
+        using INDEX_MODE = sfr::EVSYS::QDIRMv;
+
+        inline constexpr uint8_t CHANNELS = 8;
+
+        /// event multiplexer input for a port pin. Only ports A-F can generate events.
+        template <class PORT, uint8_t PIN>
+        constexpr SOURCE pin_source(const GPIO::pin<PORT, PIN>) noexcept {
+            constexpr uint16_t port = (PORT::BaseAddress - decltype(device::PORTA)::BaseAddress) / 0x20U;
+            static_assert(port < 6, "Only pins on ports A-F can be event sources");
+            return static_cast<SOURCE>(static_cast<uint8_t>(SOURCE::PORTA_PIN0) + port * 8U + PIN);
+        }
+
+        /// event multiplexer input for an event channel number, as used by the TC and ADC event selection
+        template <uint8_t CH>
+        constexpr uint8_t channel_select() noexcept {
+            static_assert(CH < CHANNELS, "Event channels are 0-7");
+            return 0x08U | CH;
+        }
+
+        /// let the EventRouter pick the channel of a link
+        inline constexpr uint8_t AUTO = 0xFF;
+
+        /// channels the EventRouter never hands out, as a mask. Channels 6 and 7 drive the microsecond
+        /// timebase, see drivers/timebase.hpp, which is set up outside the router.
+        inline constexpr uint8_t RESERVED = (1U << 6U) | (1U << 7U);
+
+        /// channels a consumer of a link can use, as a mask with bit n for channel n
+        namespace consumer {
+            inline constexpr uint8_t ANY = 0xFF;            // TC event actions and ADC triggers see every channel
+            inline constexpr uint8_t DMA = 0x07;            // DMA triggers only exist for channels 0-2
+            inline constexpr uint8_t QUADRATURE = 0x15;     // quadrature decoding is on channels 0, 2 and 4
+        }
+
+        /**
+         * An event link: a source routed to one channel for a set of consumers.
+         * @tparam CONSUMERS mask of channels every consumer of the link can use, see EVSYS::consumer
+         * @tparam CHANNEL a fixed channel, or AUTO
+         */
+        template <SOURCE S, uint8_t CONSUMERS = consumer::ANY, FILTER F = FILTER::_1SAMPLE, uint8_t CHANNEL = AUTO>
+        struct link {
+            static_assert(CHANNEL == AUTO || CHANNEL < CHANNELS, "Event channels are 0-7");
+            static constexpr SOURCE source = S;
+            static constexpr uint8_t consumers = CONSUMERS;
+            static constexpr FILTER filter = F;
+            static constexpr uint8_t channel = CHANNEL;
+            static constexpr uint8_t width = 1;     // number of consecutive channels used
+            static constexpr uint8_t control = static_cast<uint8_t>(F);
+        };
+
+        /**
+         * A quadrature decoder link. Phase A is the source pin, phase B must be the next pin of the port. With
+         * index recognition the index must be the pin after phase B, and it takes the next channel as well.
+         */
+        template <SOURCE PHASE_A, bool INDEX = false, INDEX_MODE MODE = INDEX_MODE::_00, FILTER F = FILTER::_1SAMPLE, uint8_t CHANNEL = AUTO>
+        struct quadrature_link {
+            static_assert(CHANNEL == AUTO || CHANNEL == 0 || CHANNEL == 2 || CHANNEL == 4, "Quadrature decoding is only available on event channels 0, 2 and 4");
+            static_assert(static_cast<uint8_t>(PHASE_A) >= static_cast<uint8_t>(SOURCE::PORTA_PIN0)
+                          && static_cast<uint8_t>(PHASE_A) <= static_cast<uint8_t>(SOURCE::PORTA_PIN0) + 0x2FU
+                          && (static_cast<uint8_t>(PHASE_A) & 0x07U) <= (INDEX ? 5U : 6U),
+                          "Quadrature phase A must be a pin with phase B (and the index) on the following pins");
+            static constexpr SOURCE source = PHASE_A;
+            static constexpr uint8_t consumers = consumer::QUADRATURE;
+            static constexpr FILTER filter = F;
+            static constexpr uint8_t channel = CHANNEL;
+            static constexpr uint8_t width = INDEX ? 2 : 1;
+            static constexpr uint8_t control = static_cast<uint8_t>((static_cast<uint8_t>(MODE) << 5U) | (INDEX ? (1U << 4U) : 0U) | (1U << 3U) | static_cast<uint8_t>(F));
+            static constexpr SOURCE index_source = static_cast<SOURCE>(static_cast<uint8_t>(PHASE_A) + 2U);
+        };
+
+        /// result of the channel allocation, one channel per link
+        template <size_t N>
+        struct allocation {
+            std::array<uint8_t, N> channels{};
+            bool fixed_conflict = false;
+            bool valid = true;
+        };
+
+        /// channels of a link that would be taken if it started at channel ch
+        constexpr uint8_t span_mask(const uint8_t ch, const uint8_t width) noexcept {
+            return static_cast<uint8_t>(((1U << width) - 1U) << ch);
+        }
+
+        /**
+         * Allocate the channels at compile time. Fixed links are placed first, then the remaining links from
+         * the most constrained (fewest allowed channels) to the least, each on the lowest free channel. The
+         * RESERVED channels are never used.
+         */
+        template <size_t N>
+        constexpr allocation<N> allocate(const std::array<uint8_t, N>& consumers, const std::array<uint8_t, N>& widths,
+                                         const std::array<uint8_t, N>& fixed) noexcept {
+            allocation<N> a{};
+            uint16_t used = RESERVED;
+            for(size_t i = 0; i < N; ++i) {
+                a.channels[i] = AUTO;
+                if(fixed[i] != AUTO) {
+                    const uint16_t mask = span_mask(fixed[i], widths[i]);
+                    if((used & mask) || fixed[i] + widths[i] > CHANNELS || !(consumers[i] & (1U << fixed[i]))) {
+                        a.fixed_conflict = true;
+                        a.valid = false;
+                        return a;
+                    }
+                    used |= mask;
+                    a.channels[i] = fixed[i];
+                }
+            }
+            for(uint8_t choices = 1; choices <= CHANNELS; ++choices) {
+                for(size_t i = 0; i < N; ++i) {
+                    uint8_t count = 0;
+                    for(uint8_t ch = 0; ch < CHANNELS; ++ch) { count += (consumers[i] >> ch) & 1U; }
+                    if(a.channels[i] != AUTO || count != choices) { continue; }
+                    for(uint8_t ch = 0; ch + widths[i] <= CHANNELS; ++ch) {
+                        const uint16_t mask = span_mask(ch, widths[i]);
+                        if((consumers[i] & (1U << ch)) && !(used & mask)) {
+                            used |= mask;
+                            a.channels[i] = ch;
+                            break;
+                        }
+                    }
+                    if(a.channels[i] == AUTO) {
+                        a.valid = false;
+                        return a;
+                    }
+                }
+            }
+            return a;
+        }
+    }   // namespace EVSYS
+
+    /**
+     * Zero overhead driver for the event system. Channels are template parameters so each access is a
+     * single register write, for example: drivers::EVSYS_Basic events(device::EVSYS);
+     */
+    template <typename EVSYS_INSTANCE>
+    class EVSYS_Basic {
+        EVSYS_INSTANCE m_instance;
+//        decltype(device::EVSYS) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        template <uint8_t CH>
+        using MUX = ucpp::registers::reg_t<uint8_t, EVSYS_INSTANCE::BaseAddress + CH>;
+        template <uint8_t CH>
+        using CTRL = ucpp::registers::reg_t<uint8_t, EVSYS_INSTANCE::BaseAddress + EVSYS::CHANNELS + CH>;
+
+    public:
+        constexpr EVSYS_Basic(const EVSYS_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// route an event source to a channel, OFF disconnects the channel
+        template <uint8_t CH>
+        constexpr void set_source(const EVSYS::SOURCE source) const noexcept {
+            static_assert(CH < EVSYS::CHANNELS, "Event channels are 0-7");
+            MUX<CH>::write(static_cast<uint8_t>(source));
+        }
+
+        /// set the digital filter: an event must be stable for this many peripheral clock samples
+        template <uint8_t CH>
+        constexpr void set_filter(const EVSYS::FILTER filter) const noexcept {
+            static_assert(CH < EVSYS::CHANNELS, "Event channels are 0-7");
+            CTRL<CH>::write(static_cast<uint8_t>(filter));
+        }
+
+        /**
+         * Enable quadrature decoding on channel 0, 2 or 4. The phase A pin is routed to this channel and
+         * phase B to the next pin; with index recognition the index pin is routed to the channel after that.
+         */
+        template <uint8_t CH>
+        constexpr void set_quadrature(const bool index, const EVSYS::INDEX_MODE mode = EVSYS::INDEX_MODE::_00,
+                                      const EVSYS::FILTER filter = EVSYS::FILTER::_1SAMPLE) const noexcept {
+            static_assert(CH == 0 || CH == 2 || CH == 4, "Quadrature decoding is only available on event channels 0, 2 and 4");
+            constexpr uint8_t QDEN = 1U << 3U;
+            constexpr uint8_t QDIEN = 1U << 4U;
+            CTRL<CH>::write(static_cast<uint8_t>((static_cast<uint8_t>(mode) << 5U) | (index ? QDIEN : 0U) | QDEN | static_cast<uint8_t>(filter)));
+        }
+
+        /// disable quadrature decoding and filtering on a channel
+        template <uint8_t CH>
+        constexpr void clear_control() const noexcept {
+            static_assert(CH < EVSYS::CHANNELS, "Event channels are 0-7");
+            CTRL<CH>::write(0);
+        }
+
+        /// generate events in software on the channels in mask, with the DATA register as the event value
+        constexpr void strobe(const uint8_t mask, const uint8_t data = 0xFFU) const noexcept {
+            m_instance.DATA = data;
+            m_instance.STROBE = mask;
+        }
+    };
+
+    /**
+     * Event system routing declared at compile time. Each link connects a source (a pin, a timer, the ADC...)
+     * to a channel that its consumers (timer capture or counting, ADC start, DMA trigger) listen to. The channels
+     * are allocated while compiling and overlapping or impossible routes fail with a static_assert, so the
+     * peripheral chains of the whole board are described in one place and cost nothing at runtime but the
+     * register writes in start(). The EVSYS::RESERVED channels are left to the timebase.
+     *
+     * example:
+     *   using capture = drivers::EVSYS::link<drivers::EVSYS::SOURCE::PORTD_PIN0>;
+     *   using sample = drivers::EVSYS::link<drivers::EVSYS::SOURCE::TCC0_OVF, drivers::EVSYS::consumer::DMA>;
+     *   drivers::EventRouter<decltype(device::EVSYS), capture, sample> events(device::EVSYS);
+     *   events.start();
+     *   timer.set_event(events.tc_source<capture>());
+     *   dma.set_trigger(events.dma_trigger<sample>());
+     */
+    template <typename EVSYS_INSTANCE, typename... LINKS>
+    class EventRouter {
+        static constexpr size_t N = sizeof...(LINKS);
+        static constexpr EVSYS::allocation<N> ALLOCATION = EVSYS::allocate<N>({ LINKS::consumers... }, { LINKS::width... }, { LINKS::channel... });
+        static_assert(!ALLOCATION.fixed_conflict, "Event links with fixed channels overlap, are on a reserved channel, or use a channel their consumers can't see");
+        static_assert(ALLOCATION.fixed_conflict || ALLOCATION.valid, "Not enough event channels for all links and their consumers");
+
+        EVSYS_Basic<EVSYS_INSTANCE> m_events;
+
+        template <typename LINK, size_t... Is>
+        static constexpr size_t index_of(std::index_sequence<Is...>) noexcept {
+            return ((std::is_same_v<LINK, LINKS> ? Is : 0) + ...);
+        }
+
+        template <size_t I, typename LINK>
+        void apply() const noexcept {
+            constexpr uint8_t CH = ALLOCATION.channels[I];
+            m_events.template set_source<CH>(LINK::source);
+            ucpp::registers::reg_t<uint8_t, EVSYS_INSTANCE::BaseAddress + EVSYS::CHANNELS + CH>::write(LINK::control);
+            if constexpr (LINK::width == 2) {
+                m_events.template set_source<CH + 1>(LINK::index_source);
+                m_events.template set_filter<CH + 1>(LINK::filter);
+            }
+        }
+
+        template <typename LINK>
+        void remove() const noexcept {
+            m_events.template set_source<channel<LINK>()>(EVSYS::SOURCE::OFF);
+            if constexpr (LINK::width == 2) {
+                m_events.template set_source<channel<LINK>() + 1>(EVSYS::SOURCE::OFF);
+            }
+        }
+
+        template <size_t... Is>
+        void apply_all(std::index_sequence<Is...>) const noexcept {
+            (apply<Is, LINKS>(), ...);
+        }
+
+    public:
+        constexpr EventRouter(const EVSYS_INSTANCE instance)
+            : m_events(instance)
+        {}
+
+        /// the channel allocated to a link
+        template <typename LINK>
+        static constexpr uint8_t channel() noexcept {
+            static_assert((std::is_same_v<LINK, LINKS> + ...) == 1, "Link is not routed by this EventRouter, or is listed twice");
+            return ALLOCATION.channels[index_of<LINK>(std::index_sequence_for<LINKS...>{})];
+        }
+
+        /// event selection of a timer (TC CTRLD.EVSEL) listening to a link
+        template <typename LINK>
+        static constexpr sfr::TC::EVSELv tc_source() noexcept {
+            return static_cast<sfr::TC::EVSELv>(EVSYS::channel_select<channel<LINK>()>());
+        }
+
+        /// event selection of an ADC (EVCTRL.EVSEL) whose first event channel is the link
+        template <typename LINK>
+        static constexpr sfr::ADC::EVSELv adc_source() noexcept {
+            return static_cast<sfr::ADC::EVSELv>(channel<LINK>());
+        }
+
+        /// DMA trigger for a link, which must be declared with the EVSYS::consumer::DMA mask
+        template <typename LINK>
+        static constexpr sfr::DMA::CH_TRIGSRCv dma_trigger() noexcept {
+            static_assert(channel<LINK>() < 3, "DMA triggers only exist for event channels 0-2, declare the link with EVSYS::consumer::DMA");
+            return static_cast<sfr::DMA::CH_TRIGSRCv>(channel<LINK>() + 1U);
+        }
+
+        /// write the multiplexer and control register of every link
+        void start() const noexcept {
+            apply_all(std::index_sequence_for<LINKS...>{});
+        }
+
+        /// disconnect every link. The channels keep their filter settings.
+        void stop() const noexcept {
+            (remove<LINKS>(), ...);
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
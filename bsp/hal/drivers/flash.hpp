@@ -37,11 +37,20 @@
  *      }
  *
  *      [[gnu::progmem]] constexpr auto test = make_table();
+ *
+ * The LPM reads below use 16-bit addresses and only reach the first 64K of flash. Large tables on the 128K and
+ * 256K parts should be placed with FAR_PGMSPACE and read through flash::far_array, which uses ELPM and RAMPZ.
  */
 
 #pragma once
 
+#include "device.hpp"       // RAMPZ for far flash reads
+#include "nonstd/span.hpp"  // span for non-owning bulk copies
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
 #include <avr/pgmspace.h>
 
 #ifndef __AVR_HAVE_LPMX__
@@ -49,6 +58,8 @@
 #endif
 
 #define PGMSPACE [[gnu::progmem]]
+/// place constant data after the code, which may be above 64K. Read it with flash::far_array.
+#define FAR_PGMSPACE [[gnu::section(".progmemx.data")]]
 
 namespace flash {
 
@@ -155,9 +166,164 @@ namespace flash {
     struct flash_string {
         static constexpr bool in_flash = true;
         static constexpr char value[sizeof...(C) + 1] [[gnu::progmem]] = {C..., '\0'};
+        /// the characters without the terminator, for parsing at compile time. Never stored.
+        static constexpr std::array<char, sizeof...(C)> chars = {C...};
         constexpr operator const char*() const { return value; }
     };
 
+    /**
+     * Build a table at compile time from a constexpr generator, for use with PGMSPACE or FAR_PGMSPACE.
+     * example:
+     *     FAR_PGMSPACE constexpr auto squares = flash::generate<uint16_t, 256>([](size_t i) { return i*i; });
+     */
+    template <typename T, size_t N, typename F>
+    constexpr std::array<T, N> generate(F&& f) noexcept {
+        std::array<T, N> table{};
+        for(size_t i = 0; i < N; ++i) {
+            table[i] = static_cast<T>(f(i));
+        }
+        return table;
+    }
+
+    /**
+     * 24-bit flash address of an object. The address is only known at link time, so it is loaded with
+     * immediates from the symbol instead of through a 16-bit pointer, which would be truncated.
+     * example: const uint32_t addr = flash::far_address<font>();
+     */
+    template <const auto& OBJECT>
+    inline uint32_t far_address() noexcept {
+        uint32_t addr;
+        asm(
+        "ldi %A0, lo8(%1) \n"
+        "ldi %B0, hi8(%1) \n"
+        "ldi %C0, hh8(%1) \n"
+        "clr %D0          \n"
+        : "=d"(addr)
+        : "p"(&OBJECT));
+        return addr;
+    }
+
+    /**
+     * Copy bytes from a 24-bit flash address with post-increment ELPM. RAMPZ:Z increments as one
+     * 24-bit pointer, so a copy can cross a 64K boundary. RAMPZ is restored afterwards.
+     * @param addr [IN] 24-bit flash address to copy from
+     * @param dst [OUT] SRAM destination
+     * @param count [IN] number of bytes to copy
+     */
+    inline void far_copy(const uint32_t addr, void* dst, uint16_t count) noexcept {
+        if(count == 0) { return; }
+        const uint8_t rampz = device::CPU.RAMPZ;
+        uint16_t z = static_cast<uint16_t>(addr);
+        asm volatile(
+        "out %[rampz], %[page]     \n"
+        "1: elpm __tmp_reg__, Z+   \n"
+        "st %a[dst]+, __tmp_reg__  \n"
+        "sbiw %[count], 1          \n"
+        "brne 1b                   \n"
+        : [dst] "+e"(dst), [count] "+w"(count), "+z"(z)
+        : [rampz] "I"(decltype(device::CPU)::RAMPZ_t::address),
+          [page] "r"(static_cast<uint8_t>(addr >> 16U))
+        : "memory");
+        device::CPU.RAMPZ = rampz;
+    }
+
+    /// read one object from a 24-bit flash address
+    template <typename T>
+    inline T far_read(const uint32_t addr) noexcept {
+        T value;
+        far_copy(addr, &value, sizeof(T));
+        return value;
+    }
+
+    /// random access iterator over objects in far flash. Dereferencing reads a copy of the element.
+    template <typename T>
+    class far_iterator {
+        uint32_t m_addr;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = T;
+
+        constexpr explicit far_iterator(const uint32_t addr) noexcept : m_addr(addr) {}
+
+        T operator*() const noexcept { return far_read<T>(m_addr); }
+        T operator[](const difference_type n) const noexcept { return *(*this + n); }
+
+        constexpr far_iterator& operator++() noexcept { m_addr += sizeof(T); return *this; }
+        constexpr far_iterator& operator--() noexcept { m_addr -= sizeof(T); return *this; }
+        constexpr far_iterator operator++(int) noexcept { const auto it = *this; ++*this; return it; }
+        constexpr far_iterator operator--(int) noexcept { const auto it = *this; --*this; return it; }
+        constexpr far_iterator& operator+=(const difference_type n) noexcept { m_addr += n * sizeof(T); return *this; }
+        constexpr far_iterator& operator-=(const difference_type n) noexcept { m_addr -= n * sizeof(T); return *this; }
+        constexpr far_iterator operator+(const difference_type n) const noexcept { return far_iterator(m_addr + n * sizeof(T)); }
+        constexpr far_iterator operator-(const difference_type n) const noexcept { return far_iterator(m_addr - n * sizeof(T)); }
+        constexpr difference_type operator-(const far_iterator& rhs) const noexcept {
+            return (static_cast<int32_t>(m_addr) - static_cast<int32_t>(rhs.m_addr)) / static_cast<int32_t>(sizeof(T));
+        }
+
+        constexpr bool operator==(const far_iterator& rhs) const noexcept { return m_addr == rhs.m_addr; }
+        constexpr bool operator!=(const far_iterator& rhs) const noexcept { return m_addr != rhs.m_addr; }
+        constexpr bool operator<(const far_iterator& rhs) const noexcept { return m_addr < rhs.m_addr; }
+        constexpr bool operator>(const far_iterator& rhs) const noexcept { return m_addr > rhs.m_addr; }
+        constexpr bool operator<=(const far_iterator& rhs) const noexcept { return m_addr <= rhs.m_addr; }
+        constexpr bool operator>=(const far_iterator& rhs) const noexcept { return m_addr >= rhs.m_addr; }
+
+        /// 24-bit flash address of the current element
+        [[nodiscard]] constexpr uint32_t address() const noexcept { return m_addr; }
+    };
+
+    /**
+     * View of a std::array stored anywhere in flash, including above 64K. Only the 24-bit address is kept
+     * in SRAM; elements are read with ELPM on access.
+     * example:
+     *     FAR_PGMSPACE constexpr auto font = flash::generate<uint8_t, 4096>(glyph_column);
+     *     const auto glyphs = flash::make_far_array<font>();
+     *     std::array<uint8_t, 8> column;
+     *     glyphs.copy_to(column, 'A' * 8);
+     */
+    template <typename T, size_t N>
+    class far_array {
+        uint32_t m_addr;
+    public:
+        static constexpr bool in_flash = true;
+        using value_type = T;
+        using iterator = far_iterator<T>;
+
+        constexpr explicit far_array(const uint32_t addr) noexcept : m_addr(addr) {}
+
+        [[nodiscard]] static constexpr size_t size() noexcept { return N; }
+        [[nodiscard]] static constexpr size_t size_bytes() noexcept { return N * sizeof(T); }
+
+        [[nodiscard]] T operator[](const size_t i) const noexcept { return far_read<T>(m_addr + i * sizeof(T)); }
+        [[nodiscard]] iterator begin() const noexcept { return iterator(m_addr); }
+        [[nodiscard]] iterator end() const noexcept { return iterator(m_addr + size_bytes()); }
+
+        /**
+         * Stream elements into SRAM in one ELPM loop.
+         * @param dst [OUT] destination, filled as far as the table allows
+         * @param first [IN] index of the first element to copy
+         * @return number of elements copied
+         */
+        size_t copy_to(nonstd::span<T> dst, const size_t first = 0) const noexcept {
+            if(first >= N) { return 0; }
+            const size_t count = (dst.size() < N - first) ? dst.size() : N - first;
+            far_copy(m_addr + first * sizeof(T), dst.data(), count * sizeof(T));
+            return count;
+        }
+
+        /// 24-bit flash address of the table
+        [[nodiscard]] uint32_t address() const noexcept { return m_addr; }
+    };
+
+    /// far_array view of a std::array placed in flash with PGMSPACE or FAR_PGMSPACE
+    template <const auto& TABLE>
+    inline auto make_far_array() noexcept {
+        using table_t = std::remove_cv_t<std::remove_reference_t<decltype(TABLE)>>;
+        return far_array<typename table_t::value_type, std::tuple_size<table_t>::value>(far_address<TABLE>());
+    }
+
     namespace flash_literals {
         // this is a GNU extension! there is no standard conforming method to create flash string with custom operator
         // https://stackoverflow.com/questions/54278201/what-is-c20s-string-literal-operator-template
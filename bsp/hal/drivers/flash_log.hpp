@@ -0,0 +1,280 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/nvm.hpp"         // flash page buffer and application section page commands
+#include "nonstd/crc.hpp"          // per page integrity check
+#include "nonstd/expected.hpp"     // std::expected implementation for safe return value
+#include "nonstd/span.hpp"         // span for non-owning range based read/write functions
+#include <array>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace FLASH_LOG {
+        /// list of flash log errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            BUSY = (1U<<7U),
+            TOO_LARGE = (1U<<6U),
+            NOT_FOUND = (1U<<5U),
+            NVM_ERROR = (1U<<4U),
+            NONE = (1U<<0U)
+        };
+
+        /// page header: sequence number, length of the records and CRC-16, all little endian
+        inline constexpr uint8_t HEADER_SIZE = 8;
+        /// largest record, records never span pages
+        inline constexpr uint8_t MAX_RECORD_SIZE = 255;
+    }
+
+    /**
+     * Circular log of records in a range of application section flash pages, for keeping sensor data while
+     * there is no host to send it to.
+     *
+     * Records of 1 to 255 bytes are appended to a page sized buffer in RAM, each with a length byte, so
+     * append() is a copy and never touches the flash. A record that doesn't fit closes the page: the header
+     * is filled in, the page is loaded into the flash page buffer and one erase-and-write of the next page
+     * is started. The flash is written once per page, not once per record, and every page is erased once per
+     * trip around the log. The oldest page is overwritten when the log wraps.
+     *
+     * Each page starts with a sequence number one higher than the page before, the length of its records,
+     * and a CRC-16 over the sequence number, the records and the length. start() takes the valid page with
+     * the newest sequence number as the head, so after a power failure the log carries on after the last
+     * complete page. A page torn by a power failure fails its CRC and is skipped. Records still in RAM are
+     * lost on a power failure; call flush() before sleeping or powering down.
+     *
+     * readout() sends every page from the oldest to the newest, and the records still in RAM, as one frame
+     * each, for scripts/telemetry_decode.py to split back into records. Pages are numbered from 1; the
+     * records in RAM go out with sequence number 0, since they are not stored yet and a later readout sends
+     * them again, possibly with more, under the number of the page they end up in.
+     *
+     * The region must not hold code: place it above the end of the program, for example the last pages of
+     * the application section. Code fetched from the application section stalls until a page write is done,
+     * which happens once per page of records.
+     *
+     * Resources: one flash page of RAM for the records being gathered and 10 bytes of state. The NVM
+     * interrupts are not used.
+     *
+     * example: drivers::Flash_Log<decltype(device::NVM), drivers::NVM::APP_PAGES - 64, 64> datalog(device::NVM);
+     *          datalog.start();  ...  datalog.append(record);  ...  datalog.readout(tx, peripheral::telemetry::log_page);
+     * @tparam FIRST_PAGE first application section page used by the log
+     * @tparam PAGES number of pages used by the log
+     */
+    template <typename NVM_INSTANCE, uint16_t FIRST_PAGE, uint16_t PAGES>
+    class Flash_Log {
+        static_assert(PAGES >= 2, "The flash log needs at least two pages");
+        static_assert(FIRST_PAGE + PAGES <= NVM::APP_PAGES, "The flash log does not fit in the application section");
+
+        static constexpr uint16_t PAGE_SIZE = NVM::FLASH_PAGE_SIZE;
+        static constexpr uint16_t MAX_LENGTH = PAGE_SIZE - FLASH_LOG::HEADER_SIZE;
+        /// pages are read through a small buffer on the stack
+        static constexpr uint8_t CHUNK = 32;
+
+        NVM_Basic<NVM_INSTANCE> m_nvm;
+        std::array<uint8_t, PAGE_SIZE> m_page{};    // the page being gathered, header first
+        uint32_t m_sequence = 0;                    // sequence number of the newest page in flash
+        uint16_t m_head = PAGES - 1U;               // newest page in flash, relative to FIRST_PAGE
+        uint16_t m_length = 0;                      // bytes of records in m_page
+
+        static constexpr uint32_t page_address(const uint16_t page) noexcept {
+            return static_cast<uint32_t>(FIRST_PAGE + page) * PAGE_SIZE;
+        }
+
+        static constexpr uint16_t next(const uint16_t page) noexcept {
+            return (page + 1U) % PAGES;
+        }
+
+        static constexpr uint32_t get32(const uint8_t* p) noexcept {
+            return p[0] | (static_cast<uint32_t>(p[1]) << 8U) | (static_cast<uint32_t>(p[2]) << 16U) | (static_cast<uint32_t>(p[3]) << 24U);
+        }
+
+        /**
+         * Read a page header and check the page.
+         * @return the length of the records in the page, if it is valid
+         */
+        [[nodiscard]] nonstd::expected<uint16_t, FLASH_LOG::error> check(const uint16_t page, uint32_t& sequence) const noexcept {
+            std::array<uint8_t, FLASH_LOG::HEADER_SIZE> header;
+            m_nvm.flash_read(page_address(page), header);
+            sequence = get32(&header[0]);
+            const uint16_t length = header[4] | (header[5] << 8U);
+            if(length > MAX_LENGTH) {
+                return nonstd::make_unexpected(FLASH_LOG::error::NOT_FOUND);   // erased, or not a log page
+            }
+            uint16_t crc = nonstd::crc16({ &header[0], 4 });
+            std::array<uint8_t, CHUNK> chunk;
+            for(uint16_t offset = 0; offset < length; offset += CHUNK) {
+                const uint16_t n = (length - offset < CHUNK) ? length - offset : CHUNK;
+                m_nvm.flash_read(page_address(page) + FLASH_LOG::HEADER_SIZE + offset, { chunk.data(), n });
+                crc = nonstd::crc16({ chunk.data(), n }, crc);
+            }
+            crc = nonstd::crc16({ &header[4], 2 }, crc);
+            if(crc != (header[6] | (header[7] << 8U))) {
+                return nonstd::make_unexpected(FLASH_LOG::error::NOT_FOUND);
+            }
+            return length;
+        }
+
+        /// send one page as a frame: the tag, the sequence number and the records
+        template <typename SINK>
+        void send(SINK& frames, const uint8_t tag, const uint32_t sequence, const uint32_t address, const uint16_t length) const noexcept {
+            frames.begin();
+            frames.write(tag);
+            for(uint8_t i = 0; i < 4; ++i) {
+                frames.write(static_cast<uint8_t>(sequence >> (8U * i)));
+            }
+            std::array<uint8_t, CHUNK> chunk;
+            for(uint16_t offset = 0; offset < length; offset += CHUNK) {
+                const uint16_t n = (length - offset < CHUNK) ? length - offset : CHUNK;
+                m_nvm.flash_read(address + offset, { chunk.data(), n });
+                frames.write(nonstd::span<const uint8_t>{ chunk.data(), n });
+            }
+            frames.end();
+        }
+
+    public:
+        constexpr Flash_Log(const NVM_INSTANCE instance)
+            : m_nvm(instance)
+        {}
+
+        /// find the newest page, so the log carries on after it. Blocks while the pages are read.
+        void start() noexcept {
+            m_nvm.wait();
+            m_head = PAGES - 1U;
+            m_sequence = 0;
+            m_length = 0;
+            bool found = false;
+            for(uint16_t page = 0; page < PAGES; ++page) {
+                uint32_t sequence = 0;
+                if(check(page, sequence) && (!found || static_cast<int32_t>(sequence - m_sequence) > 0)) {
+                    m_head = page;
+                    m_sequence = sequence;
+                    found = true;
+                }
+            }
+        }
+
+        /// erase the whole region and start an empty log. Blocks until every page is erased.
+        [[nodiscard]] nonstd::expected<bool, FLASH_LOG::error> clear() noexcept {
+            for(uint16_t page = 0; page < PAGES; ++page) {
+                m_nvm.wait();
+                if(!m_nvm.start_flash_erase(FIRST_PAGE + page, NVM::SPM_INT_LVL::OFF)) {
+                    return nonstd::make_unexpected(FLASH_LOG::error::NVM_ERROR);
+                }
+            }
+            m_nvm.wait();
+            m_head = PAGES - 1U;
+            m_sequence = 0;
+            m_length = 0;
+            return true;
+        }
+
+        /**
+         * Add a record. Only copies it to RAM, unless it closes a full page.
+         * @param record [IN] 1 to FLASH_LOG::MAX_RECORD_SIZE bytes
+         * @return BUSY if the page is full and the write of the page before hasn't finished; the record is not
+         *         added and can be tried again
+         */
+        [[nodiscard]] nonstd::expected<bool, FLASH_LOG::error> append(nonstd::span<const uint8_t> record) noexcept {
+            if(record.empty() || record.size() > FLASH_LOG::MAX_RECORD_SIZE) {
+                return nonstd::make_unexpected(FLASH_LOG::error::TOO_LARGE);
+            }
+            if(m_length + 1U + record.size() > MAX_LENGTH) {
+                const auto r = flush();
+                if(!r) { return r; }
+            }
+            uint8_t* p = &m_page[FLASH_LOG::HEADER_SIZE + m_length];
+            *p++ = static_cast<uint8_t>(record.size());
+            for(const uint8_t b : record) { *p++ = b; }
+            m_length += 1U + record.size();
+            return true;
+        }
+
+        /**
+         * Write the gathered records to the next page now, whether it is full or not. The write is started
+         * and left running. The rest of a partly filled page is left unused.
+         */
+        [[nodiscard]] nonstd::expected<bool, FLASH_LOG::error> flush() noexcept {
+            if(m_length == 0) { return true; }
+            if(m_nvm.busy()) { return nonstd::make_unexpected(FLASH_LOG::error::BUSY); }
+
+            const uint32_t sequence = m_sequence + 1U;
+            for(uint8_t i = 0; i < 4; ++i) {
+                m_page[i] = static_cast<uint8_t>(sequence >> (8U * i));
+            }
+            m_page[4] = static_cast<uint8_t>(m_length);
+            m_page[5] = static_cast<uint8_t>(m_length >> 8U);
+            uint16_t crc = nonstd::crc16({ &m_page[0], 4 });
+            crc = nonstd::crc16({ &m_page[FLASH_LOG::HEADER_SIZE], m_length }, crc);
+            crc = nonstd::crc16({ &m_page[4], 2 }, crc);
+            m_page[6] = static_cast<uint8_t>(crc);
+            m_page[7] = static_cast<uint8_t>(crc >> 8U);
+
+            const uint16_t page = next(m_head);
+            const uint16_t used = (FLASH_LOG::HEADER_SIZE + m_length + 1U) & ~1U;   // loads are whole words
+            m_nvm.flash_flush_buffer();
+            if(!m_nvm.flash_load(0, { m_page.data(), used })) {
+                return nonstd::make_unexpected(FLASH_LOG::error::NVM_ERROR);
+            }
+            if(!m_nvm.start_flash_erase_write(FIRST_PAGE + page, NVM::SPM_INT_LVL::OFF)) {
+                return nonstd::make_unexpected(FLASH_LOG::error::NVM_ERROR);
+            }
+            m_head = page;
+            m_sequence = sequence;
+            m_length = 0;
+            return true;
+        }
+
+        /**
+         * Send the log, oldest page first, then the records still in RAM. Each page is one frame: the tag, the
+         * 32-bit little endian sequence number, then the records, each a length byte and its bytes. The frame
+         * of the records in RAM has sequence number 0.
+         * Blocks while the pages are read.
+         * @param frames [IN] anything with begin(), write(uint8_t), write(span) and end(), like a nonstd::slip::encoder
+         * @param tag [IN] first byte of each frame, telling it apart from other frames on the link
+         * @return the number of frames sent
+         */
+        template <typename SINK>
+        uint16_t readout(SINK& frames, const uint8_t tag) const noexcept {
+            m_nvm.wait();
+            uint16_t sent = 0;
+            // pages are written in order, so the page i places after the head was written PAGES - i pages ago
+            for(uint16_t i = 1; i <= PAGES; ++i) {
+                const uint16_t page = (m_head + i) % PAGES;
+                uint32_t sequence = 0;
+                const auto length = check(page, sequence);
+                if(length && sequence == m_sequence - (PAGES - i)) {
+                    send(frames, tag, sequence, page_address(page) + FLASH_LOG::HEADER_SIZE, length.value());
+                    ++sent;
+                }
+            }
+            if(m_length != 0) {
+                frames.begin();
+                frames.write(tag);
+                for(uint8_t i = 0; i < 4; ++i) {
+                    frames.write(0);
+                }
+                frames.write(nonstd::span<const uint8_t>{ &m_page[FLASH_LOG::HEADER_SIZE], m_length });
+                frames.end();
+                ++sent;
+            }
+            return sent;
+        }
+
+        /// sequence number of the newest page in flash, 0 for an empty log
+        [[nodiscard]] constexpr uint32_t sequence() const noexcept { return m_sequence; }
+
+        /// bytes of records gathered in RAM and not written yet
+        [[nodiscard]] constexpr uint16_t pending() const noexcept { return m_length; }
+
+        /// bytes of records a page holds, including their length bytes
+        [[nodiscard]] static constexpr uint16_t page_capacity() noexcept { return MAX_LENGTH; }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"           // need this to forward the enum definitions
+#include "drivers/cpu.hpp"      // protected write for the vector table location
+#include <cstdint>
+
+namespace drivers {
+
+    namespace INTERRUPT {
+        /// interrupt levels, the same values as the INTLVL fields of every peripheral
+        enum class LEVEL : uint8_t { OFF = 0, LO = 1, MED = 2, HI = 3 };
+
+        /// interrupt sources of each kind of peripheral, in vector order
+        namespace SOURCE {
+            namespace PORT { inline constexpr uint8_t INT0 = 0, INT1 = 1; }
+            namespace DMA { inline constexpr uint8_t CH0 = 0, CH1 = 1, CH2 = 2, CH3 = 3; }
+            namespace RTC { inline constexpr uint8_t OVF = 0, COMP = 1; }
+            namespace TWI { inline constexpr uint8_t TWIS = 0, TWIM = 1; }
+            namespace TC { inline constexpr uint8_t OVF = 0, ERR = 1, CCA = 2, CCB = 3, CCC = 4, CCD = 5; }
+            namespace SPI { inline constexpr uint8_t INT = 0; }
+            namespace USART { inline constexpr uint8_t RXC = 0, DRE = 1, TXC = 2; }
+            namespace NVM { inline constexpr uint8_t EE = 0, SPM = 1; }
+            namespace AC { inline constexpr uint8_t AC0 = 0, AC1 = 1, ACW = 2; }
+            namespace ADC { inline constexpr uint8_t CH0 = 0, CH1 = 1, CH2 = 2, CH3 = 3; }
+            namespace USB { inline constexpr uint8_t BUSEVENT = 0, TRNCOMPL = 1; }
+        }   // namespace SOURCE
+
+        /**
+         * Vector number of an interrupt source of a peripheral instance, at compile time. Use it to check a
+         * binding against the instance a driver was built for.
+         * example: static_assert(drivers::INTERRUPT::vector<decltype(device::USARTE0)>(drivers::INTERRUPT::SOURCE::USART::DRE) == XMEGA_VECTOR_USARTE0_DRE);
+         */
+        template <typename INSTANCE>
+        constexpr uint8_t vector(const uint8_t source) noexcept {
+            constexpr uint8_t first = device::vectors::first(INSTANCE::BaseAddress);
+            static_assert(first != 0, "This peripheral has no interrupts");
+            return static_cast<uint8_t>(first + source);
+        }
+    }   // namespace INTERRUPT
+
+    /**
+     * Zero overhead driver for the programmable multilevel interrupt controller, for example:
+     * drivers::PMIC_Basic pmic(device::PMIC);
+     *
+     * Each peripheral interrupt is given a level in its own INTCTRL register, and a level only runs once it
+     * is enabled here. A higher level interrupts a lower one. Within the low level, round robin scheduling
+     * stops a low vector number from starving the ones after it.
+     */
+    template <typename PMIC_INSTANCE>
+    class PMIC_Basic {
+        PMIC_INSTANCE m_instance;
+//        decltype(device::PMIC) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr PMIC_Basic(const PMIC_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// enable the interrupt levels. Interrupts must also be enabled globally, see CPU::enable_interrupts().
+        constexpr void enable(const bool lo = true, const bool med = true, const bool hi = true, const bool round_robin = false) const noexcept {
+            m_instance.CTRL = static_cast<uint8_t>((m_instance.CTRL.read() & m_instance.CTRL.IVSEL.mask)
+                            | m_instance.CTRL.LOLVLEN.shift(lo).value
+                            | m_instance.CTRL.MEDLVLEN.shift(med).value
+                            | m_instance.CTRL.HILVLEN.shift(hi).value
+                            | m_instance.CTRL.RREN.shift(round_robin).value);
+        }
+
+        /// disable one interrupt level, pending interrupts of that level stay pending
+        constexpr void disable(const INTERRUPT::LEVEL lvl) const noexcept {
+            switch(lvl) {
+                case INTERRUPT::LEVEL::LO: m_instance.CTRL.LOLVLEN = false; break;
+                case INTERRUPT::LEVEL::MED: m_instance.CTRL.MEDLVLEN = false; break;
+                case INTERRUPT::LEVEL::HI: m_instance.CTRL.HILVLEN = false; break;
+                default: break;
+            }
+        }
+
+        /// move the vector table to the boot section, for a boot loader, or back to the application section
+        void set_boot_vectors(const bool boot) const noexcept {
+            uint8_t value = m_instance.CTRL.read() & static_cast<uint8_t>(~m_instance.CTRL.IVSEL.mask);
+            if(boot) { value |= m_instance.CTRL.IVSEL.mask; }
+            CPU::protected_write(m_instance.CTRL, value);
+        }
+
+        /// true while an interrupt of the level is running, or was interrupted by a higher level. Always false for OFF.
+        [[nodiscard]] constexpr bool executing(const INTERRUPT::LEVEL lvl) const noexcept {
+            if(lvl == INTERRUPT::LEVEL::OFF) { return false; }
+            return m_instance.STATUS.read() & (1U << (static_cast<uint8_t>(lvl) - 1U));
+        }
+    };
+
+}   // namespace drivers
+
+/**
+ * Bind a static handler to an interrupt vector, by the vector name from the device's vectors.hpp.
+ * The vector calls the handler directly, which the compiler inlines, so there is no table of function
+ * pointers and no indirect call: the ISR costs the same as a hand written one.
+ * Use it once per vector, at namespace scope in a source file.
+ * example: XMEGA_ISR(RTC_OVF, Scheduler_t::handle_overflow)
+ *          XMEGA_ISR(USARTE0_DRE, [] { uart.handle_dre(); })
+ */
+#define XMEGA_ISR(NAME, HANDLER) XMEGA_ISR_NUMBER(XMEGA_VECTOR_##NAME, HANDLER)
+#define XMEGA_ISR_NUMBER(NUMBER, HANDLER) XMEGA_ISR_DEFINE(NUMBER, HANDLER)
+#if SIMULATION_BUILD
+#   define XMEGA_ISR_DEFINE(NUMBER, HANDLER) \
+        extern "C" void __vector_##NUMBER(); \
+        extern "C" void __vector_##NUMBER() { (HANDLER)(); }
+#else
+#   define XMEGA_ISR_DEFINE(NUMBER, HANDLER) \
+        extern "C" void __vector_##NUMBER() __attribute__((signal, used, externally_visible)); \
+        extern "C" void __vector_##NUMBER() { (HANDLER)(); }
+#endif
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
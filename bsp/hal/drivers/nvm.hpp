@@ -0,0 +1,421 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include "drivers/cpu.hpp"  // configuration change protected writes
+#include "nonstd/expected.hpp"     // std::expected implementation for safe return value
+#include "nonstd/span.hpp"         // span for non-owning range based read/write functions
+#include <cstdint>
+#if SIMULATION_BUILD
+#include <array>
+#else
+#include "drivers/flash.hpp"       // ELPM reads of the application section
+#endif
+
+namespace drivers {
+
+    namespace NVM {
+        using COMMAND = sfr::NVM::CMDv;
+        using SPM_INT_LVL = sfr::NVM::SPMLVLv;
+        using EE_INT_LVL = sfr::NVM::EELVLv;
+
+        inline constexpr uint16_t FLASH_PAGE_SIZE = device::flash_page_size;
+        inline constexpr uint8_t  EEPROM_PAGE_SIZE = device::eeprom_page_size;
+        inline constexpr uint16_t EEPROM_SIZE = device::eeprom_section.size;
+        inline constexpr uint16_t EEPROM_PAGES = EEPROM_SIZE / EEPROM_PAGE_SIZE;
+        inline constexpr uint16_t APP_PAGES = device::app_section.size / FLASH_PAGE_SIZE;
+
+        /// list of NVM errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            BUSY = (1U<<7U),
+            OUT_OF_RANGE = (1U<<6U),
+            NONE = (1U<<0U)
+        };
+
+        /// state of the last started operation
+        enum class status : uint8_t { IDLE, BUSY, DONE };
+
+#if !SIMULATION_BUILD
+        /**
+         * Execute an SPM based NVM command. On the XMEGA the SPM instruction only works from the boot section,
+         * so this function is linked into .boot (see the hal CMakeLists.txt). Everything else stays in the
+         * application section.
+         * @param cmd [IN] NVM command to execute with the SPM instruction
+         * @param address [IN] byte address loaded into RAMPZ:Z
+         * @param data [IN] word loaded into R1:R0, only used by the buffer load commands
+         */
+        [[gnu::section(".boot"), gnu::noinline]]
+        inline void spm(const COMMAND cmd, const uint32_t address, const uint16_t data = 0) noexcept {
+            const uint8_t rampz = device::CPU.RAMPZ;
+            device::CPU.RAMPZ = static_cast<uint8_t>(address >> 16U);
+            device::NVM.CMD = static_cast<uint8_t>(cmd);
+            asm volatile(
+                "movw r0, %[data]         \n\t"
+                "out %[ccp], %[signature] \n\t"
+                "spm                      \n\t"
+                "clr __zero_reg__         \n\t"
+                :
+                : [data] "r" (data),
+                  [ccp] "I" (decltype(device::CPU)::CCP_t::address),
+                  [signature] "r" (static_cast<uint8_t>(CPU::CCP_SIGNATURE::SPM)),
+                  "z" (static_cast<uint16_t>(address))
+                : "r0", "memory"
+            );
+            device::NVM.CMD = static_cast<uint8_t>(COMMAND::NO_OPERATION);
+            device::CPU.RAMPZ = rampz;
+        }
+
+        /// execute an LPM based NVM command (signature row reads) and return the byte at address
+        inline uint8_t lpm(const COMMAND cmd, const uint16_t address) noexcept {
+            device::NVM.CMD = static_cast<uint8_t>(cmd);
+            uint8_t result;
+            asm volatile("lpm %0, Z \n\t" : "=r"(result) : "z"(address));
+            device::NVM.CMD = static_cast<uint8_t>(COMMAND::NO_OPERATION);
+            return result;
+        }
+#endif
+    }   // namespace NVM
+
+    /**
+     * Driver for the non volatile memory controller: EEPROM, application flash and the user signature row.
+     *
+     * Writes go through the page buffers. Load the buffer with eeprom_load()/flash_load(), then start an
+     * erase, write, or erase-and-write of the page. The start functions return as soon as the command is
+     * issued; completion is signalled by the NVM interrupts. The app must call handle_interrupt() from the
+     * NVM_EE_vect and NVM_SPM_vect ISRs, and can poll status() or act on the return value there.
+     *
+     * Erase and write are split so the slow erase can be done ahead of time (for example when idle), and the
+     * time critical write is write-only. Only the bytes loaded into the page buffer are erased or written.
+     *
+     * EEPROM writes run in the background. Flash writes to the application section stall any code fetched
+     * from the application section until the controller is done, so keep them out of time critical paths.
+     *
+     * Resources: one byte of static state for the operation status.
+     * In a simulation build EEPROM reads and loads go straight to the memory mapped file, the application
+     * section and flash page buffer are host arrays, and commands complete immediately.
+     */
+    template <typename NVM_INSTANCE>
+    class NVM_Basic {
+        NVM_INSTANCE m_instance;
+//        decltype(device::NVM) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        static constexpr bool simulation = ucpp::registers::sim::simulation;
+        static inline volatile NVM::status s_status = NVM::status::IDLE;
+#if SIMULATION_BUILD
+        static inline std::array<uint8_t, device::app_section.size> s_flash = [] {
+            std::array<uint8_t, device::app_section.size> erased{};
+            erased.fill(0xFF);
+            return erased;
+        }();
+        static inline std::array<uint8_t, NVM::FLASH_PAGE_SIZE> s_flash_buffer = [] {
+            std::array<uint8_t, NVM::FLASH_PAGE_SIZE> erased{};
+            erased.fill(0xFF);
+            return erased;
+        }();
+
+        /// what the application page commands do to the flash, a write can only clear bits
+        static void simulate(const NVM::COMMAND cmd, const uint32_t address) noexcept {
+            const bool erase = cmd == NVM::COMMAND::ERASE_APP_PAGE || cmd == NVM::COMMAND::ERASE_WRITE_APP_PAGE;
+            const bool write = cmd == NVM::COMMAND::WRITE_APP_PAGE || cmd == NVM::COMMAND::ERASE_WRITE_APP_PAGE;
+            if(!erase && !write) { return; }
+            for(uint16_t i = 0; i < NVM::FLASH_PAGE_SIZE; ++i) {
+                uint8_t& b = s_flash[address + i];
+                if(erase) { b = 0xFF; }
+                if(write) { b &= s_flash_buffer[i]; }
+            }
+            if(write) { s_flash_buffer.fill(0xFF); }
+        }
+#endif
+
+        /// execute a command that is triggered with CMDEX, address is set first
+        constexpr void execute(const NVM::COMMAND cmd, const uint16_t address) const noexcept {
+            m_instance.ADDR0 = static_cast<uint8_t>(address);
+            m_instance.ADDR1 = static_cast<uint8_t>(address >> 8U);
+            m_instance.ADDR2 = 0;
+            m_instance.CMD = static_cast<uint8_t>(cmd);
+            CPU::protected_write(m_instance.CTRLA, m_instance.CTRLA.CMDEX.shift(true).value);
+        }
+
+        [[nodiscard]] constexpr nonstd::expected<bool, NVM::error> begin() const noexcept {
+            if(busy()) { return nonstd::make_unexpected(NVM::error::BUSY); }
+            s_status = NVM::status::BUSY;
+            return true;
+        }
+
+        /// start an EEPROM page command and arm the EEPROM ready interrupt
+        [[nodiscard]] constexpr nonstd::expected<bool, NVM::error>
+        eeprom_command(const NVM::COMMAND cmd, const uint16_t page, const NVM::EE_INT_LVL lvl) const noexcept {
+            if(page >= NVM::EEPROM_PAGES) { return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE); }
+            const auto r = begin();
+            if(!r) { return r; }
+            execute(cmd, page * NVM::EEPROM_PAGE_SIZE);
+            if constexpr (simulation) {
+                s_status = NVM::status::DONE;
+            }
+            else {
+                m_instance.INTCTRL.EELVL = lvl;
+            }
+            return true;
+        }
+
+        /// start a flash page command and arm the SPM ready interrupt
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        flash_command(const NVM::COMMAND cmd, const uint32_t address, const NVM::SPM_INT_LVL lvl) const noexcept {
+            const auto r = begin();
+            if(!r) { return r; }
+            if constexpr (simulation) {
+#if SIMULATION_BUILD
+                simulate(cmd, address);
+#endif
+                s_status = NVM::status::DONE;
+            }
+            else {
+#if !SIMULATION_BUILD
+                NVM::spm(cmd, address);
+#endif
+                m_instance.INTCTRL.SPMLVL = lvl;
+            }
+            return true;
+        }
+
+    public:
+        constexpr NVM_Basic(const NVM_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// enable memory mapped EEPROM access. Must be called before any EEPROM read or load.
+        constexpr void start() const noexcept {
+            m_instance.CTRLB.EEMAPEN = true;
+        }
+
+        /// disable memory mapped EEPROM access and the NVM interrupts
+        constexpr void stop() const noexcept {
+            m_instance.INTCTRL = 0;
+            m_instance.CTRLB.EEMAPEN = false;
+        }
+
+        /// true while the NVM controller is busy with a write or erase
+        [[nodiscard]] constexpr bool busy() const noexcept {
+            if constexpr (simulation) { return false; }
+            return m_instance.STATUS.NVMBUSY;
+        }
+
+        /// blocks until the NVM controller is ready
+        constexpr void wait() const noexcept {
+            while(busy()) {}
+        }
+
+        /// state of the last started operation. Reading a DONE status returns the driver to IDLE.
+        [[nodiscard]] constexpr NVM::status status() const noexcept {
+            const NVM::status s = s_status;
+            if(s == NVM::status::DONE) { s_status = NVM::status::IDLE; }
+            return s;
+        }
+
+        /**
+         * Call from both the NVM_EE_vect and NVM_SPM_vect interrupts. The NVM interrupts are level triggered
+         * (active while the controller is ready) so they are disabled here.
+         * @return true if this interrupt completed an operation started by this driver
+         */
+        static bool handle_interrupt() noexcept {
+            NVM_INSTANCE::INTCTRL = 0;
+            if(s_status == NVM::status::BUSY) {
+                s_status = NVM::status::DONE;
+                return true;
+            }
+            return false;
+        }
+
+        /******************************************* EEPROM *******************************************/
+
+        /// read a byte from the memory mapped EEPROM. Must not be called while the EEPROM is busy.
+        [[nodiscard]] constexpr uint8_t eeprom_read(const uint16_t addr) const noexcept {
+            const uint16_t mapped = device::eeprom_section.start + addr;
+            if constexpr (simulation) {
+                return ucpp::registers::sim::read<uint8_t>(mapped);
+            }
+            else {
+                return *reinterpret_cast<volatile const uint8_t*>(mapped);
+            }
+        }
+
+        /// read a range of the memory mapped EEPROM into buffer. Must not be called while the EEPROM is busy.
+        [[nodiscard]] constexpr nonstd::expected<uint16_t, NVM::error>
+        eeprom_read(const uint16_t addr, nonstd::span<uint8_t> buffer) const noexcept {
+            if(addr + buffer.size() > NVM::EEPROM_SIZE) { return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE); }
+            if(busy()) { return nonstd::make_unexpected(NVM::error::BUSY); }
+            uint16_t a = addr;
+            for(uint8_t& d : buffer) {
+                d = eeprom_read(a++);
+            }
+            return buffer.size();
+        }
+
+        /**
+         * Load a byte into the EEPROM page buffer. The page offset is taken from addr, the page itself is
+         * chosen when the page command is started. Must not be called while the EEPROM is busy.
+         */
+        constexpr void eeprom_load(const uint16_t addr, const uint8_t value) const noexcept {
+            const uint16_t mapped = device::eeprom_section.start + addr;
+            if constexpr (simulation) {
+                ucpp::registers::sim::write<uint8_t>(mapped, value);
+            }
+            else {
+                *reinterpret_cast<volatile uint8_t*>(mapped) = value;
+            }
+        }
+
+        /// load a range of bytes into the EEPROM page buffer. The range must not cross a page boundary.
+        [[nodiscard]] constexpr nonstd::expected<uint16_t, NVM::error>
+        eeprom_load(const uint16_t addr, nonstd::span<const uint8_t> data) const noexcept {
+            const uint16_t offset = addr % NVM::EEPROM_PAGE_SIZE;
+            if(addr + data.size() > NVM::EEPROM_SIZE || offset + data.size() > NVM::EEPROM_PAGE_SIZE) {
+                return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE);
+            }
+            if(busy()) { return nonstd::make_unexpected(NVM::error::BUSY); }
+            uint16_t a = addr;
+            for(const uint8_t& d : data) {
+                eeprom_load(a++, d);
+            }
+            return data.size();
+        }
+
+        /// discard anything loaded into the EEPROM page buffer
+        constexpr void eeprom_flush_buffer() const noexcept {
+            wait();
+            if(m_instance.STATUS.EELOAD) {
+                execute(NVM::COMMAND::ERASE_EEPROM_BUFFER, 0);
+                wait();
+            }
+        }
+
+        /// start erasing a whole EEPROM page. Marks the whole page buffer as loaded, so flush it first.
+        [[nodiscard]] constexpr nonstd::expected<bool, NVM::error>
+        start_eeprom_erase(const uint16_t page, const NVM::EE_INT_LVL lvl = NVM::EE_INT_LVL::LO) const noexcept {
+            if(busy()) { return nonstd::make_unexpected(NVM::error::BUSY); }
+            for(uint8_t i = 0; i < NVM::EEPROM_PAGE_SIZE; ++i) {
+                eeprom_load(page * NVM::EEPROM_PAGE_SIZE + i, 0xFF);
+            }
+            return eeprom_command(NVM::COMMAND::ERASE_EEPROM_PAGE, page, lvl);
+        }
+
+        /// start a write-only of the loaded bytes. The bytes must have been erased first.
+        [[nodiscard]] constexpr nonstd::expected<bool, NVM::error>
+        start_eeprom_write(const uint16_t page, const NVM::EE_INT_LVL lvl = NVM::EE_INT_LVL::LO) const noexcept {
+            return eeprom_command(NVM::COMMAND::WRITE_EEPROM_PAGE, page, lvl);
+        }
+
+        /// start an atomic erase and write of the loaded bytes
+        [[nodiscard]] constexpr nonstd::expected<bool, NVM::error>
+        start_eeprom_erase_write(const uint16_t page, const NVM::EE_INT_LVL lvl = NVM::EE_INT_LVL::LO) const noexcept {
+            return eeprom_command(NVM::COMMAND::ERASE_WRITE_EEPROM_PAGE, page, lvl);
+        }
+
+        /******************************************* FLASH ********************************************/
+
+        /**
+         * Read from the application section with ELPM, so the whole section is reachable. Wait for the NVM
+         * controller first, the application section can't be read during a write to it.
+         * @param address [IN] byte address in flash
+         * @param buffer [OUT] receives the bytes
+         */
+        void flash_read(const uint32_t address, nonstd::span<uint8_t> buffer) const noexcept {
+#if SIMULATION_BUILD
+            for(uint16_t i = 0; i < buffer.size(); ++i) {
+                buffer[i] = s_flash[address + i];
+            }
+#else
+            flash::far_copy(address, buffer.data(), buffer.size());
+#endif
+        }
+
+        /**
+         * Load a word into the flash page buffer.
+         * @param offset [IN] byte offset in the page, must be even
+         * @param word [IN] little endian word to load
+         */
+        void flash_load(const uint16_t offset, const uint16_t word) const noexcept {
+#if SIMULATION_BUILD
+            s_flash_buffer[offset % NVM::FLASH_PAGE_SIZE] = static_cast<uint8_t>(word);
+            s_flash_buffer[(offset + 1U) % NVM::FLASH_PAGE_SIZE] = static_cast<uint8_t>(word >> 8U);
+#else
+            NVM::spm(NVM::COMMAND::LOAD_FLASH_BUFFER, offset % NVM::FLASH_PAGE_SIZE, word);
+#endif
+        }
+
+        /// load a range of bytes into the flash page buffer. Offset and size must be even and inside one page.
+        [[nodiscard]] nonstd::expected<uint16_t, NVM::error>
+        flash_load(const uint16_t offset, nonstd::span<const uint8_t> data) const noexcept {
+            if((offset | data.size()) & 1U || offset + data.size() > NVM::FLASH_PAGE_SIZE) {
+                return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE);
+            }
+            if(busy()) { return nonstd::make_unexpected(NVM::error::BUSY); }
+            for(uint16_t i = 0; i < data.size(); i += 2) {
+                flash_load(offset + i, data[i] | (data[i + 1] << 8U));
+            }
+            return data.size();
+        }
+
+        /// discard anything loaded into the flash page buffer
+        constexpr void flash_flush_buffer() const noexcept {
+            wait();
+            if(m_instance.STATUS.FLOAD) {
+                execute(NVM::COMMAND::ERASE_FLASH_BUFFER, 0);
+                wait();
+            }
+        }
+
+        /// start erasing an application section page
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        start_flash_erase(const uint16_t page, const NVM::SPM_INT_LVL lvl = NVM::SPM_INT_LVL::LO) const noexcept {
+            if(page >= NVM::APP_PAGES) { return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE); }
+            return flash_command(NVM::COMMAND::ERASE_APP_PAGE, static_cast<uint32_t>(page) * NVM::FLASH_PAGE_SIZE, lvl);
+        }
+
+        /// start writing the page buffer to an erased application section page
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        start_flash_write(const uint16_t page, const NVM::SPM_INT_LVL lvl = NVM::SPM_INT_LVL::LO) const noexcept {
+            if(page >= NVM::APP_PAGES) { return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE); }
+            return flash_command(NVM::COMMAND::WRITE_APP_PAGE, static_cast<uint32_t>(page) * NVM::FLASH_PAGE_SIZE, lvl);
+        }
+
+        /// start an atomic erase and write of an application section page from the page buffer
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        start_flash_erase_write(const uint16_t page, const NVM::SPM_INT_LVL lvl = NVM::SPM_INT_LVL::LO) const noexcept {
+            if(page >= NVM::APP_PAGES) { return nonstd::make_unexpected(NVM::error::OUT_OF_RANGE); }
+            return flash_command(NVM::COMMAND::ERASE_WRITE_APP_PAGE, static_cast<uint32_t>(page) * NVM::FLASH_PAGE_SIZE, lvl);
+        }
+
+        /*************************************** USER SIGNATURE ***************************************/
+
+        /// read a byte from the user signature row
+        [[nodiscard]] uint8_t read_user_signature(const uint16_t offset) const noexcept {
+#if SIMULATION_BUILD
+            return 0xFF;
+#else
+            return NVM::lpm(NVM::COMMAND::READ_USER_SIG_ROW, offset);
+#endif
+        }
+
+        /// start erasing the user signature row
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        start_user_signature_erase(const NVM::SPM_INT_LVL lvl = NVM::SPM_INT_LVL::LO) const noexcept {
+            return flash_command(NVM::COMMAND::ERASE_USER_SIG_ROW, 0, lvl);
+        }
+
+        /// start writing the flash page buffer to the erased user signature row
+        [[nodiscard]] nonstd::expected<bool, NVM::error>
+        start_user_signature_write(const NVM::SPM_INT_LVL lvl = NVM::SPM_INT_LVL::LO) const noexcept {
+            return flash_command(NVM::COMMAND::WRITE_USER_SIG_ROW, 0, lvl);
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,166 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"           // need this to forward the enum definitions
+#include "drivers/sleep.hpp"    // sleep mode selection
+#include <cstdint>
+#include <type_traits>
+
+namespace drivers {
+
+    namespace POWER {
+        /// power reduction register (0 = PRGEN, 1 = PRPA ... 6 = PRPF) and bit of a peripheral
+        struct gate {
+            uint8_t offset;
+            uint8_t mask;
+        };
+
+        /// find the power reduction bit of a peripheral from its address, at compile time
+        constexpr gate gate_of(const uint16_t address) noexcept {
+            switch(address) {
+                case 0x0100U: return { 0, 0x01U };      // DMA
+                case 0x0180U: return { 0, 0x02U };      // EVSYS
+                case 0x0400U: return { 0, 0x04U };      // RTC
+                case 0x0440U: return { 0, 0x08U };      // EBI
+                case 0x00C0U: return { 0, 0x10U };      // AES
+                case 0x04C0U: return { 0, 0x40U };      // USB
+                case 0x0200U: case 0x0240U: return { static_cast<uint8_t>(1U + ((address >> 6U) & 1U)), 0x02U };   // ADCA, ADCB
+                case 0x0300U: case 0x0320U: return { static_cast<uint8_t>(1U + ((address >> 5U) & 1U)), 0x04U };   // DACA, DACB
+                case 0x0380U: case 0x0390U: return { static_cast<uint8_t>(1U + ((address >> 4U) & 1U)), 0x01U };   // ACA, ACB
+                case 0x0480U: case 0x0490U: case 0x04A0U: case 0x04B0U:
+                    return { static_cast<uint8_t>(3U + ((address >> 4U) & 0x03U)), 0x40U };                        // TWIC-TWIF
+                default: break;
+            }
+            if(address >= 0x0800U && address < 0x0C00U) {
+                const auto port = static_cast<uint8_t>(3U + ((address >> 8U) - 8U));
+                switch(address & 0xFFU) {
+                    case 0x00U: return { port, 0x01U };     // TC0 and TC2
+                    case 0x40U: return { port, 0x02U };     // TC1
+                    case 0x90U: return { port, 0x04U };     // HIRES
+                    case 0xC0U: return { port, 0x08U };     // SPI
+                    case 0xA0U: return { port, 0x10U };     // USART0
+                    case 0xB0U: return { port, 0x20U };     // USART1
+                    default: break;
+                }
+            }
+            return { 0xFFU, 0 };
+        }
+
+        /// the EBI, and its power reduction bit, only exist on the A1U
+        template <typename PRGEN, typename = void>
+        struct has_ebi : std::false_type {};
+        template <typename PRGEN>
+        struct has_ebi<PRGEN, std::void_t<decltype(PRGEN::EBI)>> : std::true_type {};
+
+        using PR_INSTANCE = decltype(device::PR);
+
+        /// peripherals that need the peripheral clock to do anything, so they keep the CPU in idle sleep.
+        /// The event system, the RTC and the analog comparators work without it.
+        inline constexpr uint8_t CLOCKED_GENERAL = 0x01U | 0x10U | 0x40U | (has_ebi<decltype(PR_INSTANCE::PRGEN)>::value ? 0x08U : 0U);   // DMA, AES, USB, EBI
+        inline constexpr uint8_t GENERAL_ALL = CLOCKED_GENERAL | 0x02U | 0x04U;     // and EVSYS, RTC
+        inline constexpr uint8_t RTC_MASK = 0x04U;
+        inline constexpr uint8_t CLOCKED_ANALOG = 0x02U | 0x04U;                     // ADC, DAC
+        inline constexpr uint8_t ANALOG_ALL = CLOCKED_ANALOG | 0x01U;                // and AC
+        inline constexpr uint8_t PORT_ALL = 0x7FU;                                   // everything on ports C-F needs the clock
+
+        template <typename INSTANCE>
+        constexpr gate gate_of() noexcept {
+            constexpr gate g = gate_of(INSTANCE::BaseAddress);
+            static_assert(g.offset != 0xFFU, "This peripheral has no power reduction bit");
+            return g;
+        }
+
+        /// the power reduction register of a gate
+        template <uint8_t OFFSET>
+        using pr_register = ucpp::registers::reg_t<uint8_t, PR_INSTANCE::BaseAddress + OFFSET>;
+
+        /**
+         * Turn on the clock of a peripheral. Its registers can't be read or written while it is gated, so the
+         * drivers call this before touching the peripheral.
+         */
+        template <typename INSTANCE>
+        inline void enable(const INSTANCE = {}) noexcept {
+            constexpr gate g = gate_of<INSTANCE>();
+            pr_register<g.offset>::write(pr_register<g.offset>::read() & static_cast<uint8_t>(~g.mask));
+        }
+
+        /// stop the clock of a peripheral. The peripheral must be disabled first, it keeps its register values.
+        template <typename INSTANCE>
+        inline void disable(const INSTANCE = {}) noexcept {
+            constexpr gate g = gate_of<INSTANCE>();
+            pr_register<g.offset>::write(pr_register<g.offset>::read() | g.mask);
+        }
+
+        /// true if the clock of a peripheral is running
+        template <typename INSTANCE>
+        [[nodiscard]] inline bool enabled(const INSTANCE = {}) noexcept {
+            constexpr gate g = gate_of<INSTANCE>();
+            return !(pr_register<g.offset>::read() & g.mask);
+        }
+    }   // namespace POWER
+
+    /**
+     * Power manager: clock gating through the power reduction registers and sleep mode selection.
+     *
+     * All peripheral clocks run after reset. gate_all() stops every one of them at start up, then the
+     * Uart, TWI, SPI and ADC drivers turn their own clock on in start() (and init() for the ADC) and off
+     * again in stop(). Other peripherals are turned on by the app with POWER::enable(), for example
+     * drivers::POWER::enable(device::TCC0), before their driver is used.
+     *
+     * The power reduction bits are the record of what is running, and sleep() picks the deepest sleep mode
+     * that keeps all of it working: idle while any peripheral that needs the peripheral clock is on, power
+     * save while the RTC is on, power down otherwise. Pin change, comparator and async event wake ups work
+     * in every mode.
+     *
+     * example: drivers::PowerManager power(device::SLEEP);
+     *          power.gate_all();  ...  for(;;) { cli(); if(!work) { power.sleep(); } sei(); }
+     */
+    template <typename SLEEP_INSTANCE>
+    class PowerManager {
+        SLEEP_Basic<SLEEP_INSTANCE> m_sleep;
+
+    public:
+        constexpr PowerManager(const SLEEP_INSTANCE sleep)
+            : m_sleep(sleep)
+        {}
+
+        /// stop the clock of every peripheral. Call before starting any driver.
+        void gate_all() const noexcept {
+            POWER::PR_INSTANCE::PRGEN = POWER::GENERAL_ALL;
+            POWER::PR_INSTANCE::PRPA = POWER::ANALOG_ALL;
+            POWER::PR_INSTANCE::PRPB = POWER::ANALOG_ALL;
+            POWER::PR_INSTANCE::PRPC = POWER::PORT_ALL;
+            POWER::PR_INSTANCE::PRPD = POWER::PORT_ALL;
+            POWER::PR_INSTANCE::PRPE = POWER::PORT_ALL;
+            POWER::PR_INSTANCE::PRPF = POWER::PORT_ALL;
+        }
+
+        /// the deepest sleep mode the running peripherals allow
+        [[nodiscard]] SLEEP::MODE sleep_mode() const noexcept {
+            const uint8_t general = POWER::PR_INSTANCE::PRGEN.read();
+            const bool clocked = (general & POWER::CLOCKED_GENERAL) != POWER::CLOCKED_GENERAL
+                || (POWER::PR_INSTANCE::PRPA.read() & POWER::CLOCKED_ANALOG) != POWER::CLOCKED_ANALOG
+                || (POWER::PR_INSTANCE::PRPB.read() & POWER::CLOCKED_ANALOG) != POWER::CLOCKED_ANALOG
+                || (POWER::PR_INSTANCE::PRPC.read() & POWER::PORT_ALL) != POWER::PORT_ALL
+                || (POWER::PR_INSTANCE::PRPD.read() & POWER::PORT_ALL) != POWER::PORT_ALL
+                || (POWER::PR_INSTANCE::PRPE.read() & POWER::PORT_ALL) != POWER::PORT_ALL
+                || (POWER::PR_INSTANCE::PRPF.read() & POWER::PORT_ALL) != POWER::PORT_ALL;
+            if(clocked) { return SLEEP::MODE::IDLE; }
+            if(!(general & POWER::RTC_MASK)) { return SLEEP::MODE::PSAVE; }
+            return SLEEP::MODE::PDOWN;
+        }
+
+        /// sleep in the deepest allowed mode, see SLEEP_Basic::sleep(). Call with interrupts disabled.
+        void sleep() const noexcept {
+            m_sleep.sleep(sleep_mode());
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
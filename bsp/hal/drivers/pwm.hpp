@@ -0,0 +1,240 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/tc.hpp"       // timer base and period solver
+#include "device.hpp"           // need this to forward the enum definitions
+#include <cstdint>
+
+namespace drivers {
+
+    namespace PWM {
+        using FAULT_ACTION = sfr::AWEX::FDACTv;
+
+        /// timer resolution with the high-resolution extension: the timer counts 4 or 8 steps per clock
+        enum class RESOLUTION : uint8_t { NORMAL = 1, X4 = 4, X8 = 8 };
+
+        /**
+         * Solve a PWM frequency at compile time. With the high-resolution extension the timer has to run from
+         * the undivided peripheral clock, and period and compare values are in 1/4 or 1/8 clock steps.
+         * example: pwm.start(drivers::PWM::frequency<board::CPUFreq, 20'000, drivers::PWM::RESOLUTION::X8>());
+         * @tparam CpuFreq peripheral clock frequency
+         * @tparam DualSlope true for a center aligned PWM period
+         */
+        template <uint32_t CpuFreq, uint32_t Hz, RESOLUTION Resolution = RESOLUTION::NORMAL, bool DualSlope = false,
+                  uint32_t MaxErrorPpm = TC::DEFAULT_ERROR_PPM>
+        constexpr TC::timing frequency() noexcept {
+            if constexpr (Resolution == RESOLUTION::NORMAL) {
+                return TC::frequency<CpuFreq, Hz, DualSlope, MaxErrorPpm>();
+            }
+            else {
+                static_assert(Hz > 0 && Hz <= CpuFreq / 2U, "PWM frequency must be between 0 and half the CPU frequency");
+                constexpr TC::timing t = TC::solve_with(0, static_cast<uint64_t>(CpuFreq) * static_cast<uint8_t>(Resolution), Hz, DualSlope, 0xFFFFU);
+                static_assert(t.valid, "PWM frequency is too low for the high resolution extension, use a lower resolution");
+                static_assert(t.error_ppm <= MaxErrorPpm, "PWM frequency can't be reached within the allowed error");
+                return t;
+            }
+        }
+
+        /// dead time in peripheral clock cycles, rounded up so the dead time is never shorter than asked for
+        template <uint32_t CpuFreq, uint32_t Ns>
+        constexpr uint8_t dead_time_ns() noexcept {
+            constexpr uint64_t cycles = (static_cast<uint64_t>(CpuFreq) * Ns + 999'999'999U) / 1'000'000'000U;
+            static_assert(cycles <= 0xFFU, "Dead time is longer than 255 peripheral clock cycles");
+            return static_cast<uint8_t>(cycles);
+        }
+    }   // namespace PWM
+
+    /**
+     * PWM on the compare channels of a 16-bit timer, with the optional high-resolution extension of its port.
+     * Duty cycles are written to the compare buffer registers and take effect at the next UPDATE (BOTTOM or
+     * TOP), so changing the duty never produces a glitch or a runt pulse.
+     *
+     * The high-resolution extension needs the 4x peripheral clock to run at 4 times the peripheral clock,
+     * so prescalers B and C must both divide by 2 (CLK::PRESCALE_B_C::_2_2). The output pins must be set as
+     * outputs by the caller: channels A-D are pins 0-3 for timer 0 and A-B are pins 4-5 for timer 1.
+     *
+     * example: drivers::PWM_Basic pwm(device::TCC0, device::HIRESC);
+     */
+    template <typename TC_INSTANCE, typename HIRES_INSTANCE>
+    class PWM_Basic {
+        static constexpr bool TYPE1 = TC_INSTANCE::BaseAddress & 0x40U;
+        static_assert(HIRES_INSTANCE::BaseAddress == (TC_INSTANCE::BaseAddress & ~0x40U) + 0x90U,
+                      "The high-resolution extension must be the one on the timer's port");
+
+        TC_Basic<TC_INSTANCE> m_timer;
+        HIRES_INSTANCE m_hires;
+//        decltype(device::HIRESC) m_hires;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        /// high-resolution enable bit of this timer, shared with the other timer of the port
+        static constexpr uint8_t HREN = TYPE1 ? 0x02U : 0x01U;
+        static constexpr uint8_t HRPLUS = 1U << 2U;
+
+    public:
+        constexpr PWM_Basic(const TC_INSTANCE timer, const HIRES_INSTANCE hires)
+            : m_timer(timer), m_hires(hires)
+        {}
+
+        /**
+         * Configure the resolution and start the timer in single or dual slope PWM mode. Compare outputs stay
+         * disabled until enable_output() is called, so set the duty cycles first.
+         * @param t [IN] timing from PWM::frequency() with the same resolution
+         */
+        constexpr void start(const TC::timing t, const PWM::RESOLUTION resolution = PWM::RESOLUTION::NORMAL) const noexcept {
+            m_timer.stop();
+            set_resolution(resolution);
+            m_timer.start_pwm(t);
+        }
+
+        /// stop the timer. Outputs keep their current level.
+        constexpr void stop() const noexcept {
+            m_timer.stop();
+        }
+
+        /**
+         * Enable the high-resolution extension for this timer. X8 also sets HRPLUS, which the other timer of
+         * the port shares, and any other resolution clears it. The timer must be stopped.
+         */
+        constexpr void set_resolution(const PWM::RESOLUTION resolution) const noexcept {
+            uint8_t value = m_hires.CTRLA.read() & static_cast<uint8_t>(~(HREN | HRPLUS));
+            if(resolution != PWM::RESOLUTION::NORMAL) { value |= HREN; }
+            if(resolution == PWM::RESOLUTION::X8) { value |= HRPLUS; }
+            m_hires.CTRLA = value;
+        }
+
+        /// connect or disconnect the compare output of a channel from its pin
+        template <TC::CHANNEL CH>
+        constexpr void enable_output(const bool enable = true) const noexcept {
+            m_timer.template enable_channel<CH>(enable);
+        }
+
+        /// buffered compare value, in timer steps of the configured resolution
+        template <TC::CHANNEL CH>
+        constexpr void set_duty(const uint16_t value) const noexcept {
+            m_timer.template set_compare<CH>(value);
+        }
+
+        /// buffered duty cycle in 1/1000ths of the period
+        template <TC::CHANNEL CH>
+        constexpr void set_duty_permille(const TC::timing t, const uint16_t permille) const noexcept {
+            m_timer.template set_compare<CH>(TC::duty_permille(t, permille));
+        }
+
+        /// buffered period change, for frequency sweeps. Takes effect with the compare buffers.
+        constexpr void set_period(const uint16_t per) const noexcept {
+            m_timer.set_period(per);
+        }
+
+        [[nodiscard]] constexpr const TC_Basic<TC_INSTANCE>& timer() const noexcept { return m_timer; }
+    };
+
+    /**
+     * Zero overhead driver for the Advanced Waveform Extension of a type 0 timer (ports C and E).
+     *
+     * With dead time insertion each enabled compare channel drives a complementary pin pair: channel A on
+     * pins 0 (low side) and 1 (high side), B on 2 and 3, and so on. The low side follows the compare output
+     * delayed by the low side dead time, the high side is its inverse delayed by the high side dead time.
+     *
+     * In pattern generation mode the waveform of channel A is put on every pin selected by the output
+     * enable pattern, and the port output values are taken from the pattern on the next UPDATE, which gives
+     * glitch free commutation for stepper and BLDC motors.
+     *
+     * The fault protection disables the outputs in hardware when an event arrives on any channel in the
+     * fault event mask, without needing the CPU.
+     *
+     * example: drivers::AWEX_Basic awex(device::AWEXC);
+     */
+    template <typename AWEX_INSTANCE>
+    class AWEX_Basic {
+        AWEX_INSTANCE m_instance;
+//        decltype(device::AWEXC) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+    public:
+        constexpr AWEX_Basic(const AWEX_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /**
+         * Enable dead time insertion on the channels in mask (bit 0 = A ... bit 3 = D) and drive their pin pairs.
+         * The pins must be outputs. The dead times are in peripheral clock cycles, see PWM::dead_time_ns().
+         */
+        constexpr void start_dead_time(const uint8_t channels, const uint8_t low_side, const uint8_t high_side) const noexcept {
+            m_instance.DTLS = low_side;
+            m_instance.DTHS = high_side;
+            m_instance.CTRL = static_cast<uint8_t>(channels & 0x0FU);
+            uint8_t pins = 0;
+            for(uint8_t ch = 0; ch < 4; ++ch) {
+                if(channels & (1U << ch)) { pins |= static_cast<uint8_t>(0x03U << (ch * 2U)); }
+            }
+            m_instance.OUTOVEN = pins;
+        }
+
+        /// buffered dead time change, copied at the next UPDATE
+        constexpr void set_dead_time(const uint8_t low_side, const uint8_t high_side) const noexcept {
+            m_instance.DTLSBUF = low_side;
+            m_instance.DTHSBUF = high_side;
+        }
+
+        /// buffered dead time change for both sides, copied at the next UPDATE
+        constexpr void set_dead_time(const uint8_t both) const noexcept {
+            m_instance.DTBOTHBUF = both;
+        }
+
+        /// use the compare value of channel A for all channels, so one write updates every pin pair
+        constexpr void set_common_waveform(const bool common) const noexcept {
+            m_instance.CTRL.CWCM = common;
+        }
+
+        /// switch to pattern generation mode. Channel A generates the waveform for all pins.
+        constexpr void start_pattern(const uint8_t enable, const uint8_t out) const noexcept {
+            m_instance.CTRL = m_instance.CTRL.PGM.shift(true);
+            m_instance.OUTOVEN = enable;
+            set_pattern(enable, out);
+        }
+
+        /**
+         * Buffered pattern change, copied at the next UPDATE.
+         * @param enable [IN] pins that carry the waveform of channel A
+         * @param out [IN] port output values for the other pins
+         */
+        constexpr void set_pattern(const uint8_t enable, const uint8_t out) const noexcept {
+            m_instance.DTLSBUF = enable;
+            m_instance.DTHSBUF = out;
+        }
+
+        /// stop dead time insertion and pattern generation and release the pins to the port
+        constexpr void stop() const noexcept {
+            m_instance.CTRL = 0;
+            m_instance.OUTOVEN = 0;
+        }
+
+        /**
+         * Configure fault protection.
+         * @param events [IN] event channels that signal a fault, bit n = channel n
+         * @param action [IN] clear the output enables, or make the pins inputs
+         * @param latched [IN] if true the outputs stay off until clear_fault(), otherwise they come back at the
+         *                     next UPDATE after the fault event is gone
+         */
+        constexpr void set_fault(const uint8_t events, const PWM::FAULT_ACTION action, const bool latched = true) const noexcept {
+            m_instance.FDEMASK = events;
+            m_instance.FDCTRL = m_instance.FDCTRL.FDACT.shift(action) | m_instance.FDCTRL.FDMODE.shift(!latched);
+        }
+
+        /// true if a fault was detected
+        [[nodiscard]] constexpr bool fault() const noexcept {
+            return m_instance.STATUS.FDF;
+        }
+
+        /// clear the fault flag. In latched mode the output enables must be restored with start_*() too.
+        constexpr void clear_fault() const noexcept {
+            m_instance.STATUS = m_instance.STATUS.FDF.shift(true).value;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/evsys.hpp"    // decodes the phases
+#include "drivers/tc.hpp"       // counts the decoded steps
+#include "pin_types.hpp"
+#include <cstdint>
+
+namespace drivers {
+
+    /**
+     * Quadrature encoder decoding in hardware. The event channel decodes the two phases and steps a timer up or
+     * down, so the count rate does not depend on the CPU at all. With index recognition the index pulse resets
+     * the count once per revolution, which keeps the angle in sync even if counts were lost to noise.
+     *
+     * Phase A is the given pin, phase B the next pin, and the index the pin after that, all on the same port.
+     * The event channel must be 0, 2 or 4; with an index the next channel is used too.
+     *
+     * update() is meant to be called at a fixed rate, from a timer interrupt or the main loop. It takes a
+     * snapshot of the count and extends it to a 32-bit position, and the difference between snapshots is the
+     * velocity. The shaft must turn less than half a revolution between two updates.
+     *
+     * Resources: the timer and one or two event channels.
+     *
+     * example: drivers::QuadratureDecoder<decltype(device::TCD0), decltype(device::EVSYS), 0> encoder(device::TCD0, device::EVSYS);
+     *          encoder.start<true>(GPIO::pin<decltype(device::PORTD), 0>{}, 4 * 500);
+     */
+    template <typename TC_INSTANCE, typename EVSYS_INSTANCE, uint8_t EVENT_CH>
+    class QuadratureDecoder {
+        static_assert(EVENT_CH == 0 || EVENT_CH == 2 || EVENT_CH == 4, "Quadrature decoding is only available on event channels 0, 2 and 4");
+
+        TC_Basic<TC_INSTANCE> m_timer;
+        EVSYS_Basic<EVSYS_INSTANCE> m_events;
+
+        uint16_t m_counts = 0;
+        uint16_t m_last = 0;
+        int32_t m_position = 0;
+        int16_t m_velocity = 0;
+        bool m_index = false;
+
+    public:
+        constexpr QuadratureDecoder(const TC_INSTANCE timer, const EVSYS_INSTANCE events)
+            : m_timer(timer), m_events(events)
+        {}
+
+        /**
+         * Configure the pins, the event channel and the timer, and start counting from 0.
+         * @tparam INDEX reset the count on the index pulse
+         * @param phase_a [IN] phase A pin, phase B (and the index) are the following pins of the port
+         * @param counts [IN] counts per revolution, 4 times the encoder lines
+         * @param mode [IN] phase state at which the index is recognized
+         * @param filter [IN] digital filter on the phases to reject noise
+         */
+        template <bool INDEX = false, class PORT, uint8_t PIN>
+        void start(const GPIO::pin<PORT, PIN> phase_a, const uint16_t counts,
+                   const EVSYS::INDEX_MODE mode = EVSYS::INDEX_MODE::_00,
+                   const EVSYS::FILTER filter = EVSYS::FILTER::_1SAMPLE) noexcept {
+            static_assert(PIN + (INDEX ? 2 : 1) <= 7, "Phase B and the index must be on the same port as phase A");
+            const GPIO::pin<PORT, PIN + 1> phase_b{};
+            phase_a.set_input();
+            phase_b.set_input();
+            phase_a.configure(GPIO::PinConfig::SENSE_LEVEL_LOW);
+            phase_b.configure(GPIO::PinConfig::SENSE_LEVEL_LOW);
+
+            m_events.template set_source<EVENT_CH>(EVSYS::pin_source(phase_a));
+            if constexpr (INDEX) {
+                const GPIO::pin<PORT, PIN + 2> index_pin{};
+                index_pin.set_input();
+                index_pin.configure(GPIO::PinConfig::SENSE_LEVEL_LOW);
+                m_events.template set_source<EVENT_CH + 1>(EVSYS::pin_source(index_pin));
+            }
+            m_events.template set_quadrature<EVENT_CH>(INDEX, mode, filter);
+            m_index = INDEX;
+
+            m_counts = counts;
+            m_last = 0;
+            m_position = 0;
+            m_velocity = 0;
+            m_timer.stop();
+            m_timer.reset();
+            m_timer.set_event(static_cast<TC::EVENT_SOURCE>(EVSYS::channel_select<EVENT_CH>()), TC::EVENT_ACTION::QDEC);
+            m_timer.start(TC::CLOCK::DIV1, static_cast<uint16_t>(counts - 1U));
+        }
+
+        /// stop counting and release the event channels
+        void stop() noexcept {
+            m_timer.stop();
+            m_events.template clear_control<EVENT_CH>();
+            m_events.template set_source<EVENT_CH>(EVSYS::SOURCE::OFF);
+            if(m_index) {
+                m_events.template set_source<EVENT_CH + 1>(EVSYS::SOURCE::OFF);
+            }
+        }
+
+        /// take a snapshot of the count, extend the position and measure the velocity. Returns the velocity.
+        int16_t update() noexcept {
+            const uint16_t now = m_timer.count();
+            int32_t delta = static_cast<int32_t>(now) - m_last;
+            if(delta > m_counts / 2) { delta -= m_counts; }
+            else if(delta < -(m_counts / 2)) { delta += m_counts; }
+            m_last = now;
+            m_position += delta;
+            m_velocity = static_cast<int16_t>(delta);
+            return m_velocity;
+        }
+
+        /// angle within the revolution, 0 to counts-1. Read directly from the timer.
+        [[nodiscard]] uint16_t angle() const noexcept { return m_timer.count(); }
+
+        /// position in counts at the last update(), extended past a single revolution
+        [[nodiscard]] int32_t position() const noexcept { return m_position; }
+
+        /// counts moved between the last two update() calls
+        [[nodiscard]] int16_t velocity() const noexcept { return m_velocity; }
+
+        /// velocity in counts per second for an update rate of update_hz
+        [[nodiscard]] int32_t counts_per_second(const uint16_t update_hz) const noexcept {
+            return static_cast<int32_t>(m_velocity) * update_hz;
+        }
+
+        /// true if the encoder is turning backwards
+        [[nodiscard]] bool reverse() const noexcept { return m_timer.counting_down(); }
+
+        /**
+         * true if the count passed zero since the last call: a full revolution, or with index recognition the
+         * index pulse. Clears the flag.
+         */
+        [[nodiscard]] bool index() const noexcept { return m_timer.overflowed(); }
+
+        /// set the current position, for example after homing
+        void set_position(const int32_t position) noexcept {
+            m_last = m_timer.count();
+            m_position = position;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include <cstdint>
+
+namespace drivers {
+
+    namespace RTC {
+        using PRESCALER = sfr::RTC::PRESCALERv;
+        using COMPARE_INT_LVL = sfr::RTC::COMPINTLVLv;
+        using OVF_INT_LVL = sfr::RTC::OVFINTLVLv;
+    }   // namespace RTC
+
+    /**
+     * Zero overhead driver for the 16-bit real time counter, for example: drivers::RTC_Basic rtc(device::RTC);
+     * The clock source (1.024 kHz or 32.768 kHz) is selected in the clock system, see CLK_Basic::enable_rtc().
+     * The counter runs in its own clock domain: writes to CTRL, CNT, PER and COMP take two RTC clock cycles
+     * to reach it, and no new write may start before that, so every write here waits for SYNCBUSY first.
+     * The RTC keeps running in the power save and extended standby sleep modes.
+     */
+    template <typename RTC_INSTANCE>
+    class RTC_Basic {
+        RTC_INSTANCE m_instance;
+//        decltype(device::RTC) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr RTC_Basic(const RTC_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// wait for the previous write to reach the RTC clock domain
+        constexpr void wait() const noexcept {
+            while(m_instance.STATUS.read() & m_instance.STATUS.SYNCBUSY.mask) {}
+        }
+
+        /// set the period and start counting from 0
+        constexpr void start(const RTC::PRESCALER prescaler = RTC::PRESCALER::DIV1, const uint16_t per = 0xFFFFU) const noexcept {
+            wait();
+            m_instance.CTRL = 0;
+            wait();
+            m_instance.PER = per;
+            m_instance.CNT = 0;
+            wait();
+            m_instance.CTRL.PRESCALER = prescaler;
+        }
+
+        constexpr void stop() const noexcept {
+            wait();
+            m_instance.CTRL = 0;
+        }
+
+        [[nodiscard]] constexpr uint16_t count() const noexcept { return m_instance.CNT.read(); }
+
+        /// set the compare value. The compare flag is set when the count reaches it.
+        constexpr void set_compare(const uint16_t value) const noexcept {
+            wait();
+            m_instance.COMP = value;
+        }
+
+        constexpr void enable_interrupts(const RTC::OVF_INT_LVL overflow, const RTC::COMPARE_INT_LVL compare) const noexcept {
+            m_instance.INTCTRL = m_instance.INTCTRL.OVFINTLVL.shift(overflow) | m_instance.INTCTRL.COMPINTLVL.shift(compare);
+        }
+
+        /// true if the counter wrapped and the overflow interrupt has not run yet
+        [[nodiscard]] constexpr bool overflow_pending() const noexcept {
+            return m_instance.INTFLAGS.read() & m_instance.INTFLAGS.OVFIF.mask;
+        }
+
+        /// clear the compare flag, so an old match doesn't fire when the compare interrupt is enabled
+        constexpr void clear_compare() const noexcept {
+            m_instance.INTFLAGS = m_instance.INTFLAGS.COMPIF.mask;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
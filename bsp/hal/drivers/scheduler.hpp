@@ -0,0 +1,259 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/cpu.hpp"          // critical sections around the shared time
+#include "drivers/rtc.hpp"          // time base and wake up source
+#include "drivers/sleep.hpp"        // sleep between deadlines
+#include "nonstd/expected.hpp"      // std::expected implementation for safe return value
+#include <array>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace SCHEDULER {
+        /// list of scheduler errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            FULL = (1U<<7U),
+            BAD_TASK = (1U<<6U),
+            NONE = (1U<<0U)
+        };
+
+        using task_function = void (*)();
+        using ticks = uint32_t;
+
+        /// ticks for a time in milliseconds, rounded to the nearest tick, at compile time
+        template <uint32_t TickHz, uint32_t Ms>
+        constexpr ticks ms() noexcept {
+            constexpr uint64_t t = (static_cast<uint64_t>(TickHz) * Ms + 500U) / 1000U;
+            static_assert(t > 0 && t < 0x8000'0000UL, "Time must be at least one tick and less than half the time range");
+            return static_cast<ticks>(t);
+        }
+
+        /// the RTC is only reprogrammed for deadlines at least this many ticks away, writes take two RTC clocks
+        inline constexpr uint16_t MIN_COMPARE_DISTANCE = 3;
+    }   // namespace SCHEDULER
+
+    /**
+     * Cooperative, tickless task scheduler on the RTC.
+     *
+     * Tasks are plain functions that run to completion. Each has a deadline, an optional period, and a priority.
+     * The table of tasks is kept in priority order, so when several tasks are due the highest priority one runs
+     * first, and after each task the table is checked again from the top. Periodic deadlines advance by the
+     * period, not from the time the task ran, so periodic tasks don't drift; periods that were missed entirely
+     * are skipped.
+     *
+     * There is no tick interrupt. The RTC counts freely with a 16-bit period, the overflow interrupt extends it
+     * to 32-bit time, and the compare register is set to the next deadline before the CPU goes to sleep. With
+     * nothing due the CPU sleeps until that deadline, an overflow, or any other interrupt.
+     *
+     * The app must bind handle_overflow() to the RTC_OVF vector and handle_compare() to RTC_COMP, for example
+     * XMEGA_ISR(RTC_OVF, Scheduler_t::handle_overflow), see drivers/interrupt.hpp.
+     * Interrupts that make work for a task can call wake() to run it right away.
+     *
+     * Resources: the RTC, its two interrupts, 4 bytes of static time, and 13 bytes of RAM per task. The RTC
+     * clock must be enabled (see CLK_Basic::enable_rtc()); the sleep mode must keep the RTC running and any
+     * peripherals the app needs in sleep, so power save is the deepest useful mode.
+     *
+     * example: drivers::Scheduler<decltype(device::RTC), decltype(device::SLEEP), 8, 1024> scheduler(device::RTC, device::SLEEP);
+     *          scheduler.add(blink, scheduler.ms<500>());
+     *          scheduler.run(drivers::SLEEP::MODE::PSAVE);
+     * @tparam TASKS size of the task table
+     * @tparam TICK_HZ RTC tick rate, 1024 or 32768 from the clock system
+     */
+    template <typename RTC_INSTANCE, typename SLEEP_INSTANCE, uint8_t TASKS, uint32_t TICK_HZ = 1024>
+    class Scheduler {
+        struct task {
+            SCHEDULER::task_function function;
+            SCHEDULER::ticks deadline;
+            SCHEDULER::ticks period;
+            uint8_t priority;
+            uint8_t id;
+            bool active;
+        };
+
+        RTC_Basic<RTC_INSTANCE> m_rtc;
+        SLEEP_Basic<SLEEP_INSTANCE> m_sleep;
+        std::array<task, TASKS> m_tasks{};
+        uint8_t m_count = 0;
+
+        /// upper 16 bits of the time, counted by the overflow interrupt
+        static inline volatile uint16_t s_epoch = 0;
+        /// set by wake() so the dispatcher checks again instead of sleeping
+        static inline volatile bool s_wake = false;
+
+        [[nodiscard]] static constexpr bool due(const SCHEDULER::ticks deadline, const SCHEDULER::ticks now) noexcept {
+            return static_cast<int32_t>(deadline - now) <= 0;
+        }
+
+        [[nodiscard]] int8_t find(const uint8_t id) const noexcept {
+            for(uint8_t i = 0; i < m_count; ++i) {
+                if(m_tasks[i].id == id) { return static_cast<int8_t>(i); }
+            }
+            return -1;
+        }
+
+        /// run the first due task in priority order. Returns false if none was due.
+        bool dispatch_one() noexcept {
+            const SCHEDULER::ticks t = now();
+            for(uint8_t i = 0; i < m_count; ++i) {
+                task& k = m_tasks[i];
+                if(!k.active || !due(k.deadline, t)) { continue; }
+                if(k.period == 0) {
+                    k.active = false;
+                }
+                else {
+                    k.deadline += k.period;
+                    if(due(k.deadline, t)) {
+                        // skip whole missed periods, keep the phase
+                        k.deadline += ((t - k.deadline) / k.period + 1U) * k.period;
+                    }
+                }
+                k.function();
+                return true;
+            }
+            return false;
+        }
+
+        /// program the RTC compare for the earliest deadline. Returns false if a task is already due.
+        bool program_compare() noexcept {
+            const SCHEDULER::ticks t = now();
+            bool any = false;
+            SCHEDULER::ticks next = 0;
+            for(uint8_t i = 0; i < m_count; ++i) {
+                const task& k = m_tasks[i];
+                if(!k.active) { continue; }
+                if(!any || static_cast<int32_t>(k.deadline - next) < 0) { next = k.deadline; }
+                any = true;
+            }
+            if(!any) { return true; }
+            if(static_cast<int32_t>(next - t) < SCHEDULER::MIN_COMPARE_DISTANCE) { return false; }
+            // deadlines past the end of this RTC period are reached through the overflow wake up
+            if((next >> 16U) == (t >> 16U)) {
+                m_rtc.set_compare(static_cast<uint16_t>(next));
+                m_rtc.clear_compare();
+            }
+            return true;
+        }
+
+    public:
+        constexpr Scheduler(const RTC_INSTANCE rtc, const SLEEP_INSTANCE sleep)
+            : m_rtc(rtc), m_sleep(sleep)
+        {}
+
+        template <uint32_t Ms>
+        static constexpr SCHEDULER::ticks ms() noexcept { return SCHEDULER::ms<TICK_HZ, Ms>(); }
+
+        /// start the RTC and its interrupts. Interrupts must be enabled globally by the app.
+        void start(const RTC::OVF_INT_LVL overflow = RTC::OVF_INT_LVL::LO, const RTC::COMPARE_INT_LVL compare = RTC::COMPARE_INT_LVL::LO) noexcept {
+            s_epoch = 0;
+            m_rtc.start(RTC::PRESCALER::DIV1, 0xFFFFU);
+            m_rtc.enable_interrupts(overflow, compare);
+        }
+
+        /// the current time in ticks. Wraps after 2^32 ticks, compare times by their difference.
+        [[nodiscard]] SCHEDULER::ticks now() const noexcept {
+            CPU::critical_section lock;
+            uint16_t epoch = s_epoch;
+            const uint16_t count = m_rtc.count();
+            // an overflow that happened since the ISR last ran, the count has already wrapped
+            if(m_rtc.overflow_pending() && count < 0x8000U) { ++epoch; }
+            return (static_cast<SCHEDULER::ticks>(epoch) << 16U) | count;
+        }
+
+        /**
+         * Add a task.
+         * @param function [IN] the function to run
+         * @param period [IN] ticks between runs, 0 to run once
+         * @param delay [IN] ticks until the first run
+         * @param priority [IN] higher runs first when several tasks are due
+         * @return the task id, used to cancel or reschedule the task
+         */
+        [[nodiscard]] nonstd::expected<uint8_t, SCHEDULER::error>
+        add(const SCHEDULER::task_function function, const SCHEDULER::ticks period, const SCHEDULER::ticks delay = 0, const uint8_t priority = 0) noexcept {
+            if(function == nullptr) {
+                return nonstd::make_unexpected(SCHEDULER::error::BAD_TASK);
+            }
+            if(m_count == TASKS) {
+                return nonstd::make_unexpected(SCHEDULER::error::FULL);
+            }
+            uint8_t id = 0;
+            while(find(id) >= 0) { ++id; }
+            // insertion keeps the table in priority order, equal priorities in the order they were added
+            uint8_t i = m_count;
+            for(; i > 0 && m_tasks[i - 1].priority < priority; --i) {
+                m_tasks[i] = m_tasks[i - 1];
+            }
+            m_tasks[i] = { function, now() + delay, period, priority, id, true };
+            ++m_count;
+            return id;
+        }
+
+        /// remove a task from the table
+        nonstd::expected<void, SCHEDULER::error> cancel(const uint8_t id) noexcept {
+            const int8_t index = find(id);
+            if(index < 0) {
+                return nonstd::make_unexpected(SCHEDULER::error::BAD_TASK);
+            }
+            for(uint8_t i = index; i + 1U < m_count; ++i) {
+                m_tasks[i] = m_tasks[i + 1U];
+            }
+            --m_count;
+            return {};
+        }
+
+        /// run a task delay ticks from now, also a finished one shot task
+        nonstd::expected<void, SCHEDULER::error> reschedule(const uint8_t id, const SCHEDULER::ticks delay) noexcept {
+            const int8_t index = find(id);
+            if(index < 0) {
+                return nonstd::make_unexpected(SCHEDULER::error::BAD_TASK);
+            }
+            m_tasks[index].deadline = now() + delay;
+            m_tasks[index].active = true;
+            return {};
+        }
+
+        /// run every due task, highest priority first. Returns the number of tasks run.
+        uint8_t run_pending() noexcept {
+            uint8_t count = 0;
+            s_wake = false;
+            while(dispatch_one()) { ++count; }
+            return count;
+        }
+
+        /**
+         * Run tasks for ever, sleeping in between.
+         * @param mode [IN] the deepest sleep mode the app allows, it must keep the RTC running
+         */
+        [[noreturn]] void run(const SLEEP::MODE mode) noexcept {
+            for(;;) {
+                run_pending();
+                // the compare write waits for the last RTC write to sync, up to two RTC clocks. Wait for it
+                // here, so it doesn't hold off interrupts.
+                m_rtc.wait();
+                CPU::disable_interrupts();
+                if(!s_wake && program_compare()) {
+                    m_sleep.sleep(mode);    // enables interrupts
+                }
+                CPU::enable_interrupts();
+            }
+        }
+
+        /// make run() check the tasks again, for example after an ISR rescheduled one
+        static void wake() noexcept { s_wake = true; }
+
+        /// call from the RTC_OVF_vect ISR
+        static void handle_overflow() noexcept { s_epoch = s_epoch + 1U; }
+
+        /// call from the RTC_COMP_vect ISR. The wake up is all that is needed, the flag clears itself.
+        static void handle_compare() noexcept {}
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include <cstdint>
+
+namespace drivers {
+
+    namespace SLEEP {
+        using MODE = sfr::SLEEP::SMODEv;
+    }   // namespace SLEEP
+
+    /**
+     * Zero overhead driver for the sleep controller, for example: drivers::SLEEP_Basic sleep(device::SLEEP);
+     *
+     * To sleep until an interrupt without missing one that arrives just before the sleep instruction, disable
+     * interrupts, check there is nothing to do, then call sleep(). It enables interrupts right before the sleep
+     * instruction, and the AVR always executes the instruction after SEI before taking an interrupt.
+     */
+    template <typename SLEEP_INSTANCE>
+    class SLEEP_Basic {
+        SLEEP_INSTANCE m_instance;
+//        decltype(device::SLEEP) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr SLEEP_Basic(const SLEEP_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// enable interrupts and sleep in the given mode until an interrupt wakes the CPU
+        void sleep(const SLEEP::MODE mode) const noexcept {
+            m_instance.CTRL = m_instance.CTRL.SMODE.shift(mode) | m_instance.CTRL.SEN.shift(true);
+#if !SIMULATION_BUILD
+            asm volatile("sei \n\t"
+                         "sleep" ::: "memory");
+#endif
+            m_instance.CTRL.SEN = false;
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
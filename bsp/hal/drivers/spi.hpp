@@ -6,6 +6,7 @@
 
 
 #include "device.hpp"       // need this to forward the enum definitions
+#include "drivers/power.hpp"    // peripheral clock gating
 #include "pin_types.hpp"    // for pin type static checks
 #include "nonstd/expected.hpp"     // std::expected implementation for safe return value
 #include "nonstd/span.hpp"         // span for non-owning range based read/write functions
@@ -83,6 +84,7 @@ namespace drivers {
         constexpr void start(SPI::MODE Mode=SPI::MODE::_0, bool LSBFirst=false) const noexcept {
             static_assert(MaxBaud > CpuFreq/128, "Max Baud is too low! CPU / 128 can't get low enough!");
             constexpr uint8_t clk_config = SPI::calculate_clock(CpuFreq, 1'000'000U);
+            POWER::enable<SPI_INSTANCE>();
             m_instance.CTRL = clk_config
                             | m_instance.CTRL.ENABLE.shift(true)
                             | m_instance.CTRL.DORD.shift(LSBFirst)
@@ -93,6 +95,13 @@ namespace drivers {
         /// disables the twi module
         constexpr void stop() const noexcept {
             m_instance.CTRL = m_instance.CTRL.ENABLE.shift(false);
+            POWER::disable<SPI_INSTANCE>();
+        }
+
+        /// change the clock setting from SPI::calculate_clock(), for example after the CPU clock changed
+        constexpr void set_clock(const uint8_t setting) const noexcept {
+            constexpr uint8_t mask = m_instance.CTRL.CLK2X.mask | m_instance.CTRL.PRESCALER.mask;
+            m_instance.CTRL = static_cast<uint8_t>((m_instance.CTRL.read() & ~mask) | (setting & mask));
         }
 
         /// enables TWI read and write interrupts at the given level
@@ -0,0 +1,384 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "device.hpp"       // need this to forward the enum definitions
+#include <array>
+#include <cstdint>
+
+namespace drivers {
+
+    namespace TC {
+        using CLOCK = sfr::TC::CLKSELv;
+        using WAVEFORM = sfr::TC::WGMODEv;
+        using EVENT_ACTION = sfr::TC::EVACTv;
+        using EVENT_SOURCE = sfr::TC::EVSELv;
+        using COMMAND = sfr::TC::CMDv;
+        using OVF_INT_LVL = sfr::TC::OVFINTLVLv;
+        using ERR_INT_LVL = sfr::TC::ERRINTLVLv;
+        using CC_INT_LVL = sfr::TC::CCAINTLVLv;     // all four compare/capture levels use the same values
+        using SPLIT_INT_LVL = sfr::TC2::LUNFINTLVLv;
+
+        enum class CHANNEL : uint8_t { A = 0, B = 1, C = 2, D = 3 };
+
+        /// default limit on the difference between the requested and the solved timer period
+        inline constexpr uint32_t DEFAULT_ERROR_PPM = 1'000;
+
+        inline constexpr std::array<uint16_t, 7> PRESCALERS = { 1, 2, 4, 8, 64, 256, 1024 };
+        inline constexpr std::array<CLOCK, 7> PRESCALER_CLOCKS = {
+            CLOCK::DIV1, CLOCK::DIV2, CLOCK::DIV4, CLOCK::DIV8, CLOCK::DIV64, CLOCK::DIV256, CLOCK::DIV1024
+        };
+
+        /// prescaler and period register value for a timer period, see frequency() and period_us()
+        struct timing {
+            CLOCK clock;
+            uint16_t per;
+            uint32_t error_ppm;
+            bool dual_slope;
+            bool valid;
+        };
+
+        /**
+         * Timer settings for a period of cycles_num/cycles_den CPU cycles with one prescaler. Valid if the
+         * period register fits in max_per. A single slope or normal period is PER+1 ticks, a dual slope
+         * period is 2*PER ticks.
+         */
+        constexpr timing solve_with(const uint8_t prescaler, const uint64_t cycles_num, const uint64_t cycles_den,
+                                    const bool dual_slope, const uint16_t max_per) noexcept {
+            const uint64_t div = PRESCALERS[prescaler] * (dual_slope ? 2U : 1U) * cycles_den;
+            const uint64_t ticks = (cycles_num + div / 2U) / div;
+            const uint64_t per = dual_slope ? ticks : ticks - 1U;
+            if(ticks < 2 || per > max_per) {
+                return { CLOCK::OFF, 0, UINT32_MAX, dual_slope, false };
+            }
+            const uint64_t actual = ticks * div;
+            const uint64_t diff = actual > cycles_num ? actual - cycles_num : cycles_num - actual;
+            return { PRESCALER_CLOCKS[prescaler], static_cast<uint16_t>(per), static_cast<uint32_t>(diff * 1'000'000U / cycles_num), dual_slope, true };
+        }
+
+        /// find the smallest prescaler, which gives the best resolution, that reaches the period
+        constexpr timing solve(const uint64_t cycles_num, const uint64_t cycles_den, const bool dual_slope, const uint16_t max_per) noexcept {
+            for(uint8_t i = 0; i < PRESCALERS.size(); ++i) {
+                const timing t = solve_with(i, cycles_num, cycles_den, dual_slope, max_per);
+                if(t.valid) { return t; }
+            }
+            return { CLOCK::OFF, 0, UINT32_MAX, dual_slope, false };
+        }
+
+        /**
+         * Solve the timer settings for a frequency at compile time.
+         * example: timer.start(drivers::TC::frequency<board::CPUFreq, 1'000>());
+         * @tparam DualSlope true for a dual slope (center aligned) PWM period
+         * @tparam MaxErrorPpm largest allowed frequency error in parts per million
+         */
+        template <uint32_t CpuFreq, uint32_t Hz, bool DualSlope = false, uint32_t MaxErrorPpm = DEFAULT_ERROR_PPM>
+        constexpr timing frequency() noexcept {
+            static_assert(Hz > 0 && Hz <= CpuFreq / 2U, "Timer frequency must be between 0 and half the CPU frequency");
+            constexpr timing t = solve(CpuFreq, Hz, DualSlope, 0xFFFFU);
+            static_assert(t.valid, "Timer frequency is too low for the largest prescaler");
+            static_assert(t.error_ppm <= MaxErrorPpm, "Timer frequency can't be reached within the allowed error");
+            return t;
+        }
+
+        /// solve the timer settings for a period in microseconds at compile time, see frequency()
+        template <uint32_t CpuFreq, uint32_t Us, bool DualSlope = false, uint32_t MaxErrorPpm = DEFAULT_ERROR_PPM>
+        constexpr timing period_us() noexcept {
+            static_assert(Us > 0, "Timer period must be larger than 0");
+            constexpr timing t = solve(static_cast<uint64_t>(CpuFreq) * Us, 1'000'000U, DualSlope, 0xFFFFU);
+            static_assert(t.valid, "Timer period is too long or too short for the prescalers");
+            static_assert(t.error_ppm <= MaxErrorPpm, "Timer period can't be reached within the allowed error");
+            return t;
+        }
+
+        /// compare value for a duty cycle in 1/1000ths of the period
+        constexpr uint16_t duty_permille(const timing t, const uint16_t permille) noexcept {
+            const uint32_t top = t.dual_slope ? t.per : t.per + 1UL;
+            return static_cast<uint16_t>(top * permille / 1000U);
+        }
+
+        /// prescaler and both period registers for the two 8-bit counters of a split (TC2) timer
+        struct split_timing {
+            CLOCK clock;
+            uint8_t low_per;
+            uint8_t high_per;
+            uint32_t error_ppm;
+            bool valid;
+        };
+
+        /// find the smallest prescaler shared by both halves of a split timer
+        constexpr split_timing solve_split(const uint32_t cpu_freq, const uint32_t low_hz, const uint32_t high_hz) noexcept {
+            for(uint8_t i = 0; i < PRESCALERS.size(); ++i) {
+                const timing low = solve_with(i, cpu_freq, low_hz, false, 0xFFU);
+                const timing high = solve_with(i, cpu_freq, high_hz, false, 0xFFU);
+                if(low.valid && high.valid) {
+                    return { PRESCALER_CLOCKS[i], static_cast<uint8_t>(low.per), static_cast<uint8_t>(high.per),
+                             low.error_ppm > high.error_ppm ? low.error_ppm : high.error_ppm, true };
+                }
+            }
+            return { CLOCK::OFF, 0, 0, UINT32_MAX, false };
+        }
+
+        /// solve both halves of a split timer at compile time, see frequency()
+        template <uint32_t CpuFreq, uint32_t LowHz, uint32_t HighHz, uint32_t MaxErrorPpm = DEFAULT_ERROR_PPM>
+        constexpr split_timing split_frequency() noexcept {
+            static_assert(LowHz > 0 && HighHz > 0, "Timer frequency must be larger than 0");
+            constexpr split_timing t = solve_split(CpuFreq, LowHz, HighHz);
+            static_assert(t.valid, "No prescaler reaches both split timer frequencies with 8-bit periods");
+            static_assert(t.error_ppm <= MaxErrorPpm, "Split timer frequencies can't be reached within the allowed error");
+            return t;
+        }
+
+    }   // namespace TC
+
+    /**
+     * Zero overhead driver for the 16-bit Timer/Counters type 0 (4 compare channels) and type 1 (2 compare
+     * channels), for example: drivers::TC_Basic timer(device::TCC0);
+     *
+     * Timing is solved at compile time by TC::frequency() or TC::period_us(), so start() is a few register
+     * writes. Compare values are written to the buffer registers and take effect at the next UPDATE
+     * condition, so PWM duty changes are glitch free.
+     */
+    template <typename TC_INSTANCE>
+    class TC_Basic {
+        TC_INSTANCE m_instance;
+//        decltype(device::TCC0) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+
+        template <TC::CHANNEL CH>
+        static constexpr uint8_t channel_bit() noexcept {
+            static_assert(static_cast<uint8_t>(CH) < TC_Basic::channels, "Timer type 1 only has compare channels A and B");
+            return 1U << static_cast<uint8_t>(CH);
+        }
+
+    public:
+        /// type 1 timers sit 0x40 after the type 0 timer of the same port and have two channels
+        static constexpr uint8_t channels = (TC_INSTANCE::BaseAddress & 0x40U) ? 2 : 4;
+
+        constexpr TC_Basic(const TC_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /**
+         * Set the period and waveform, then start the clock.
+         * @param t [IN] timing from TC::frequency() or TC::period_us()
+         * @param mode [IN] waveform generation mode, NORMAL for a periodic overflow
+         */
+        constexpr void start(const TC::timing t, const TC::WAVEFORM mode = TC::WAVEFORM::NORMAL) const noexcept {
+            m_instance.PER = t.per;
+            m_instance.CTRLB.WGMODE = mode;
+            m_instance.CTRLA.CLKSEL = t.clock;
+        }
+
+        /// start in single slope or dual slope PWM mode, depending on how the timing was solved
+        constexpr void start_pwm(const TC::timing t) const noexcept {
+            start(t, t.dual_slope ? TC::WAVEFORM::DSBOTTOM : TC::WAVEFORM::SINGLESLOPE);
+        }
+
+        /// start with an explicit clock source, for example an event channel to count events
+        constexpr void start(const TC::CLOCK clock, const uint16_t per = 0xFFFFU, const TC::WAVEFORM mode = TC::WAVEFORM::NORMAL) const noexcept {
+            m_instance.PER = per;
+            m_instance.CTRLB.WGMODE = mode;
+            m_instance.CTRLA.CLKSEL = clock;
+        }
+
+        /// stop the timer clock. The count and settings are kept.
+        constexpr void stop() const noexcept {
+            m_instance.CTRLA.CLKSEL = TC::CLOCK::OFF;
+        }
+
+        /// true if the timer has a clock selected
+        [[nodiscard]] constexpr bool running() const noexcept {
+            return m_instance.CTRLA.read() & m_instance.CTRLA.CLKSEL.mask;
+        }
+
+        /// return all registers to their reset values. The timer must be stopped.
+        constexpr void reset() const noexcept {
+            m_instance.CTRLFSET.CMD = TC::COMMAND::RESET;
+        }
+
+        /// clear the count and the prescaler, and restart the period
+        constexpr void restart() const noexcept {
+            m_instance.CTRLFSET.CMD = TC::COMMAND::RESTART;
+        }
+
+        [[nodiscard]] constexpr uint16_t count() const noexcept { return m_instance.CNT.read(); }
+        constexpr void set_count(const uint16_t value) const noexcept { m_instance.CNT = value; }
+        [[nodiscard]] constexpr uint16_t period() const noexcept { return m_instance.PER.read(); }
+
+        /// true if the timer counts down, as set by dual slope PWM or an up/down or quadrature event action
+        [[nodiscard]] constexpr bool counting_down() const noexcept {
+            return m_instance.CTRLFSET.read() & m_instance.CTRLFSET.DIR.mask;
+        }
+
+        /// change the period at the next UPDATE condition
+        constexpr void set_period(const uint16_t per) const noexcept { m_instance.PERBUF = per; }
+
+        constexpr void enable_overflow_interrupt(const TC::OVF_INT_LVL lvl) const noexcept {
+            m_instance.INTCTRLA.OVFINTLVL = lvl;
+        }
+
+        /// true if the timer overflowed. Clears the flag if it was set.
+        [[nodiscard]] constexpr bool overflowed() const noexcept {
+            if(m_instance.INTFLAGS.OVFIF) {
+                m_instance.INTFLAGS = m_instance.INTFLAGS.OVFIF.shift(true).value;
+                return true;
+            }
+            return false;
+        }
+
+        /// true if a capture was lost because the capture buffer was full. Clears the flag if it was set.
+        [[nodiscard]] constexpr bool error() const noexcept {
+            if(m_instance.INTFLAGS.ERRIF) {
+                m_instance.INTFLAGS = m_instance.INTFLAGS.ERRIF.shift(true).value;
+                return true;
+            }
+            return false;
+        }
+
+        /// enable or disable a compare/capture channel. For PWM this drives the pin, which must be an output.
+        template <TC::CHANNEL CH>
+        constexpr void enable_channel(const bool enable = true) const noexcept {
+            constexpr uint8_t mask = channel_bit<CH>() << 4U;
+            if(enable) { m_instance.CTRLB |= mask; }
+            else { m_instance.CTRLB &= static_cast<uint8_t>(~mask); }
+        }
+
+        /// write the compare buffer. The compare register is updated at the next UPDATE condition.
+        template <TC::CHANNEL CH>
+        constexpr void set_compare(const uint16_t value) const noexcept {
+            static_assert(channel_bit<CH>() != 0);
+            if constexpr (CH == TC::CHANNEL::A) { m_instance.CCABUF = value; }
+            else if constexpr (CH == TC::CHANNEL::B) { m_instance.CCBBUF = value; }
+            else if constexpr (CH == TC::CHANNEL::C) { m_instance.CCCBUF = value; }
+            else { m_instance.CCDBUF = value; }
+        }
+
+        /// write the compare register itself, the match moves right away. Don't mix with set_compare() on a channel.
+        template <TC::CHANNEL CH>
+        constexpr void set_compare_now(const uint16_t value) const noexcept {
+            static_assert(channel_bit<CH>() != 0);
+            if constexpr (CH == TC::CHANNEL::A) { m_instance.CCA = value; }
+            else if constexpr (CH == TC::CHANNEL::B) { m_instance.CCB = value; }
+            else if constexpr (CH == TC::CHANNEL::C) { m_instance.CCC = value; }
+            else { m_instance.CCD = value; }
+        }
+
+        /// the compare value, or the last captured count in capture mode. Reading a capture clears its flag.
+        template <TC::CHANNEL CH>
+        [[nodiscard]] constexpr uint16_t compare() const noexcept {
+            static_assert(channel_bit<CH>() != 0);
+            if constexpr (CH == TC::CHANNEL::A) { return m_instance.CCA.read(); }
+            else if constexpr (CH == TC::CHANNEL::B) { return m_instance.CCB.read(); }
+            else if constexpr (CH == TC::CHANNEL::C) { return m_instance.CCC.read(); }
+            else { return m_instance.CCD.read(); }
+        }
+
+        /// last captured count, see compare()
+        template <TC::CHANNEL CH>
+        [[nodiscard]] constexpr uint16_t capture() const noexcept {
+            return compare<CH>();
+        }
+
+        /// true if the channel matched or captured since the flag was last cleared
+        template <TC::CHANNEL CH>
+        [[nodiscard]] constexpr bool triggered() const noexcept {
+            constexpr uint8_t mask = channel_bit<CH>() << 4U;
+            const uint8_t flags = m_instance.INTFLAGS.read();
+            return flags & mask;
+        }
+
+        /// clear the match or capture flag of a channel
+        template <TC::CHANNEL CH>
+        constexpr void clear_triggered() const noexcept {
+            m_instance.INTFLAGS = static_cast<uint8_t>(channel_bit<CH>() << 4U);
+        }
+
+        template <TC::CHANNEL CH>
+        constexpr void enable_channel_interrupt(const TC::CC_INT_LVL lvl) const noexcept {
+            constexpr uint8_t shift = static_cast<uint8_t>(CH) * 2U;
+            static_assert(channel_bit<CH>() != 0);
+            const uint8_t value = m_instance.INTCTRLB.read();
+            m_instance.INTCTRLB = static_cast<uint8_t>((value & ~(0x03U << shift)) | (static_cast<uint8_t>(lvl) << shift));
+        }
+
+        /**
+         * Route an event channel to the timer. With CAPT each enabled channel captures the count when
+         * the event at event channel n + the compare channel index fires; FRQ and PW use channel A only.
+         * @param source [IN] the first event channel used
+         * @param action [IN] capture, pulse width, frequency, up/down, quadrature or restart
+         * @param delay [IN] delay the event by one clock, used when cascading timers for 32-bit captures
+         */
+        constexpr void set_event(const TC::EVENT_SOURCE source, const TC::EVENT_ACTION action = TC::EVENT_ACTION::CAPT, const bool delay = false) const noexcept {
+            m_instance.CTRLD = m_instance.CTRLD.EVACT.shift(action)
+                             | m_instance.CTRLD.EVDLY.shift(delay)
+                             | m_instance.CTRLD.EVSEL.shift(source);
+        }
+    };
+
+    /**
+     * Zero overhead driver for a type 0 timer in split mode: two independent 8-bit down counters (low and high)
+     * sharing one prescaler, each with four compare channels. Use the TC2 instance of the timer, for example:
+     * drivers::TC2_Split_Basic timers(device::TCC2);
+     * Compare channels 0-3 are low A-D and channels 4-7 are high A-D. There are no buffer registers in split mode.
+     */
+    template <typename TC2_INSTANCE>
+    class TC2_Split_Basic {
+        TC2_INSTANCE m_instance;
+//        decltype(device::TCC2) m_instance;  // NOTE: This is only to assist in auto-complete. Comment out for compile.
+    public:
+        constexpr TC2_Split_Basic(const TC2_INSTANCE instance)
+            : m_instance(instance)
+        {}
+
+        /// switch to split mode, set both periods and start the shared clock
+        constexpr void start(const TC::split_timing t) const noexcept {
+            m_instance.CTRLA.CLKSEL = sfr::TC2::CLKSELv::OFF;
+            m_instance.CTRLE.BYTEM = sfr::TC2::BYTEMv::SPLITMODE;
+            m_instance.LPER = t.low_per;
+            m_instance.HPER = t.high_per;
+            m_instance.CTRLA.CLKSEL = static_cast<sfr::TC2::CLKSELv>(t.clock);
+        }
+
+        /// stop the clock and leave split mode
+        constexpr void stop() const noexcept {
+            m_instance.CTRLA.CLKSEL = sfr::TC2::CLKSELv::OFF;
+            m_instance.CTRLE.BYTEM = sfr::TC2::BYTEMv::NORMAL;
+        }
+
+        [[nodiscard]] constexpr uint8_t low_count() const noexcept { return m_instance.LCNT.read(); }
+        [[nodiscard]] constexpr uint8_t high_count() const noexcept { return m_instance.HCNT.read(); }
+
+        /// enable or disable the compare output of channel 0-7. The pin must be an output.
+        template <uint8_t CH>
+        constexpr void enable_channel(const bool enable = true) const noexcept {
+            static_assert(CH < 8, "Split timers have compare channels 0-7");
+            if(enable) { m_instance.CTRLB |= static_cast<uint8_t>(1U << CH); }
+            else { m_instance.CTRLB &= static_cast<uint8_t>(~(1U << CH)); }
+        }
+
+        /// set the compare value of channel 0-7. Takes effect immediately.
+        template <uint8_t CH>
+        constexpr void set_compare(const uint8_t value) const noexcept {
+            static_assert(CH < 8, "Split timers have compare channels 0-7");
+            if constexpr (CH == 0) { m_instance.LCMPA = value; }
+            else if constexpr (CH == 1) { m_instance.LCMPB = value; }
+            else if constexpr (CH == 2) { m_instance.LCMPC = value; }
+            else if constexpr (CH == 3) { m_instance.LCMPD = value; }
+            else if constexpr (CH == 4) { m_instance.HCMPA = value; }
+            else if constexpr (CH == 5) { m_instance.HCMPB = value; }
+            else if constexpr (CH == 6) { m_instance.HCMPC = value; }
+            else { m_instance.HCMPD = value; }
+        }
+
+        /// set the underflow interrupt levels of the low and high counters
+        constexpr void enable_interrupt(const TC::SPLIT_INT_LVL low, const TC::SPLIT_INT_LVL high) const noexcept {
+            m_instance.INTCTRLA = static_cast<uint8_t>((static_cast<uint8_t>(high) << 2U) | static_cast<uint8_t>(low));
+        }
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
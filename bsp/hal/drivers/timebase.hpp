@@ -0,0 +1,209 @@
+#pragma once
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "readability-static-accessed-through-instance"
+#endif
+
+#include "drivers/cpu.hpp"      // critical sections around the 16-bit count reads
+#include "drivers/evsys.hpp"    // microsecond clock and carry routing
+#include "drivers/power.hpp"    // the timers and the event system are gated until started
+#include "drivers/sleep.hpp"    // sleep until a deadline
+#include "drivers/tc.hpp"
+#include <cstdint>
+
+namespace drivers {
+
+    namespace TIMEBASE {
+        using micros = uint32_t;
+
+        /// event system prescaler output that ticks once per microsecond at a peripheral clock, at compile time
+        template <uint32_t PerHz>
+        constexpr EVSYS::SOURCE microsecond_clock() noexcept {
+            constexpr uint32_t div = PerHz / 1'000'000UL;
+            static_assert(PerHz % 1'000'000UL == 0 && div > 0 && (div & (div - 1U)) == 0,
+                          "The peripheral clock must be a power of two MHz for a microsecond timebase");
+            uint8_t m = 0;
+            while((1UL << m) < div) { ++m; }
+            return static_cast<EVSYS::SOURCE>(static_cast<uint8_t>(EVSYS::SOURCE::PRESCALER_1) + m);
+        }
+
+        /// event system overflow source of a type 0 or type 1 timer
+        template <typename TC_INSTANCE>
+        constexpr EVSYS::SOURCE overflow_source() noexcept {
+            constexpr uint16_t port = (TC_INSTANCE::BaseAddress - decltype(device::TCC0)::BaseAddress) / 0x100U;
+            constexpr uint8_t type1 = (TC_INSTANCE::BaseAddress & 0x40U) ? 8U : 0U;
+            return static_cast<EVSYS::SOURCE>(static_cast<uint8_t>(EVSYS::SOURCE::TCC0_OVF) + port * 0x10U + type1);
+        }
+
+        /// deadlines closer than this are waited out with interrupts on instead of sleeping, it covers arming the compare
+        inline constexpr micros SLEEP_MARGIN = 16;
+    }   // namespace TIMEBASE
+
+    /**
+     * Monotonic microsecond time from two cascaded 16-bit timers.
+     *
+     * The low timer counts a 1 MHz clock taken from the event system prescaler, so the time is exact at any
+     * power of two MHz peripheral clock, with no cycle counting. Its overflow is carried to the high timer
+     * through a second event channel, making a 32-bit count that wraps after about 71 minutes; compare times
+     * by their difference, see elapsed().
+     *
+     * sleep_until() sleeps in idle mode on the compare A interrupts: the high timer's for the 64 ms steps,
+     * then the low timer's for the last step. The app binds handle_compare() to both vectors, for example
+     * XMEGA_ISR(TCF0_CCA, Timebase_t::handle_compare) and XMEGA_ISR(TCF1_CCA, Timebase_t::handle_compare),
+     * and enables the interrupt level in the PMIC. With interrupts disabled it waits without sleeping.
+     *
+     * Resources: a type 0 or 1 timer and a type 1 or 0 timer, their compare A channels and interrupts, and two
+     * event channels. The channels must be in EVSYS::RESERVED so an EventRouter never routes anything else
+     * onto them. After a frequency step the clock channel must be re-solved with set_clock().
+     *
+     * example: using Timebase_t = drivers::Timebase<decltype(device::TCF0), decltype(device::TCF1), decltype(device::EVSYS), decltype(device::SLEEP)>;
+     *          constexpr Timebase_t timebase(device::TCF0, device::TCF1, device::EVSYS, device::SLEEP);
+     *          timebase.start<board::SystemClock::per_hz>();
+     *          const auto t0 = timebase.now();  ...  timebase.sleep_until(t0 + 1'000);
+     * @tparam CLOCK_CH event channel carrying the 1 MHz clock
+     * @tparam CARRY_CH event channel carrying the low timer overflow
+     */
+    template <typename TC_LOW, typename TC_HIGH, typename EVSYS_INSTANCE, typename SLEEP_INSTANCE, uint8_t CLOCK_CH = 6, uint8_t CARRY_CH = 7>
+    class Timebase {
+        static_assert(CLOCK_CH < EVSYS::CHANNELS && CARRY_CH < EVSYS::CHANNELS && CLOCK_CH != CARRY_CH, "The timebase needs two different event channels");
+        static_assert((EVSYS::RESERVED >> CLOCK_CH) & (EVSYS::RESERVED >> CARRY_CH) & 1U,
+                      "The timebase channels must be reserved from the EventRouter, see EVSYS::RESERVED");
+
+        TC_Basic<TC_LOW> m_low;
+        TC_Basic<TC_HIGH> m_high;
+        EVSYS_Basic<EVSYS_INSTANCE> m_evsys;
+        SLEEP_Basic<SLEEP_INSTANCE> m_sleep;
+
+        [[nodiscard]] static constexpr TC::CLOCK event_clock(const uint8_t ch) noexcept {
+            return static_cast<TC::CLOCK>(static_cast<uint8_t>(TC::CLOCK::EVCH0) + ch);
+        }
+
+        /// the carry lands one clock after the low timer wraps, and reading the low timer takes longer, so a
+        /// high count that is the same on both sides of the low read belongs to it
+        [[nodiscard]] TIMEBASE::micros read() const noexcept {
+            uint16_t high = m_high.count();
+            uint16_t low = m_low.count();
+            const uint16_t again = m_high.count();
+            if(again != high) {
+                high = again;
+                low = m_low.count();
+            }
+            return (static_cast<TIMEBASE::micros>(high) << 16U) | low;
+        }
+
+        void disarm() const noexcept {
+            m_low.template enable_channel_interrupt<TC::CHANNEL::A>(TC::CC_INT_LVL::OFF);
+            m_high.template enable_channel_interrupt<TC::CHANNEL::A>(TC::CC_INT_LVL::OFF);
+        }
+
+    public:
+        constexpr Timebase(const TC_LOW low, const TC_HIGH high, const EVSYS_INSTANCE evsys, const SLEEP_INSTANCE sleep)
+            : m_low(low), m_high(high), m_evsys(evsys), m_sleep(sleep)
+        {}
+
+        /// start counting from zero
+        template <uint32_t PerHz>
+        void start() const noexcept {
+            POWER::enable<EVSYS_INSTANCE>();
+            POWER::enable<TC_LOW>();
+            POWER::enable<TC_HIGH>();
+            m_low.stop();
+            m_high.stop();
+            m_low.set_count(0);
+            m_high.set_count(0);
+            m_evsys.template set_source<CARRY_CH>(TIMEBASE::overflow_source<TC_LOW>());
+            set_clock<PerHz>();
+            m_high.start(event_clock(CARRY_CH));
+            m_low.start(event_clock(CLOCK_CH));
+        }
+
+        /// stop the timers and gate them. The event system clock is left on, other drivers may route events.
+        void stop() const noexcept {
+            disarm();
+            m_low.stop();
+            m_high.stop();
+            m_evsys.template set_source<CLOCK_CH>(EVSYS::SOURCE::OFF);
+            m_evsys.template set_source<CARRY_CH>(EVSYS::SOURCE::OFF);
+            POWER::disable<TC_LOW>();
+            POWER::disable<TC_HIGH>();
+        }
+
+        /// true between start() and stop(). Until then now() stands still and the sleeps never end.
+        [[nodiscard]] bool running() const noexcept {
+            return m_low.running();
+        }
+
+        /// re-solve the 1 MHz clock for a new peripheral clock, for example after FrequencyScaler::set()
+        template <uint32_t PerHz>
+        void set_clock() const noexcept {
+            m_evsys.template set_source<CLOCK_CH>(TIMEBASE::microsecond_clock<PerHz>());
+        }
+
+        /// microseconds since start(). Wraps after 2^32 us, compare times by their difference.
+        [[nodiscard]] TIMEBASE::micros now() const noexcept {
+            CPU::critical_section lock;     // ISRs reading a timer would overwrite its TEMP register
+            return read();
+        }
+
+        /// microseconds since a time from now(), correct across the wrap
+        [[nodiscard]] TIMEBASE::micros elapsed(const TIMEBASE::micros since) const noexcept {
+            return now() - since;
+        }
+
+        /// true once a deadline from now() has been reached
+        [[nodiscard]] bool reached(const TIMEBASE::micros deadline) const noexcept {
+            return static_cast<int32_t>(deadline - now()) <= 0;
+        }
+
+        /**
+         * Sleep in idle mode until a deadline, waking on the timer compare interrupts, then return with
+         * the interrupt state unchanged. Other interrupts keep running and don't end the wait.
+         * @param deadline [IN] a time from now(), less than half the time range ahead
+         * @param lvl [IN] interrupt level of the compare interrupts, it must be enabled in the PMIC
+         */
+        void sleep_until(const TIMEBASE::micros deadline, const TC::CC_INT_LVL lvl = TC::CC_INT_LVL::LO) const noexcept {
+            const bool interrupts = decltype(device::CPU)::SREG.read() & decltype(device::CPU)::SREG.I.mask;
+            for(;;) {
+                CPU::disable_interrupts();
+                const auto left = static_cast<int32_t>(deadline - read());
+                if(!interrupts || left <= static_cast<int32_t>(TIMEBASE::SLEEP_MARGIN)) { break; }
+                if(left < 0x1'0000L) {
+                    // the low timer reaches the deadline before it wraps
+                    m_low.template set_compare_now<TC::CHANNEL::A>(static_cast<uint16_t>(deadline));
+                    m_low.template clear_triggered<TC::CHANNEL::A>();
+                    m_low.template enable_channel_interrupt<TC::CHANNEL::A>(lvl);
+                }
+                else {
+                    // wake when the high timer gets to the deadline's 64 ms step, then aim the low timer
+                    m_high.template set_compare_now<TC::CHANNEL::A>(static_cast<uint16_t>(deadline >> 16U));
+                    m_high.template clear_triggered<TC::CHANNEL::A>();
+                    m_high.template enable_channel_interrupt<TC::CHANNEL::A>(lvl);
+                }
+                // a match while arming sets the flag, and the interrupt wakes the sleep straight away
+                m_sleep.sleep(SLEEP::MODE::IDLE);      // enables interrupts
+                disarm();
+            }
+            if(interrupts) { CPU::enable_interrupts(); }
+            while(!reached(deadline)) {}
+        }
+
+        /// sleep for a number of microseconds, see sleep_until()
+        void sleep_for(const TIMEBASE::micros us, const TC::CC_INT_LVL lvl = TC::CC_INT_LVL::LO) const noexcept {
+            sleep_until(now() + us, lvl);
+        }
+
+        /// wait for a number of microseconds without sleeping, for waits shorter than a wake up
+        void delay(const TIMEBASE::micros us) const noexcept {
+            const TIMEBASE::micros start = now();
+            while(elapsed(start) < us) {}
+        }
+
+        /// call from the CCA ISRs of both timers. The wake up is all that is needed, the flag clears itself.
+        static void handle_compare() noexcept {}
+    };
+
+}   // namespace drivers
+
+#if __clang__
+#pragma clang diagnostic pop
+#endif
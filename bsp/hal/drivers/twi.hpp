@@ -5,6 +5,7 @@
 #endif
 
 #include "device.hpp"       // need this to forward the enum definitions
+#include "drivers/power.hpp"    // peripheral clock gating
 #include "pin_types.hpp"    // for pin type static checks
 #include "nonstd/expected.hpp"     // std::expected implementation for safe return value
 #include "nonstd/span.hpp"         // span for non-owning range based read/write functions
@@ -143,6 +144,7 @@ namespace drivers {
 
         template <uint32_t CpuFreq, uint32_t Baud = 100'000, uint32_t TRise = 0>
         constexpr void start() const noexcept {
+            POWER::enable<TWI_INSTANCE>();
             m_instance.CTRL = m_instance.CTRL.SDAHOLD.shift(TWI::SDA_HOLD::OFF)   // SDA Holdoff Time
                              | m_instance.CTRL.EDIEN.shift(false);    // External Driver Interface Enable
 
@@ -164,6 +166,22 @@ namespace drivers {
         constexpr void stop() const noexcept {
             // disable peripheral
             m_instance.MASTER.CTRLA.ENABLE = false;
+            POWER::disable<TWI_INSTANCE>();
+        }
+
+        /**
+         * Change the baud rate setting from TWI::get_baud(), for example after the CPU clock changed.
+         * BAUD may only be written while the master is disabled, so a running master is restarted with the
+         * bus idle and a stopped one stays stopped. Call it between transactions.
+         */
+        constexpr void set_baud(const uint8_t setting) const noexcept {
+            const bool enabled = m_instance.MASTER.CTRLA.ENABLE;
+            m_instance.MASTER.CTRLA.ENABLE = false;
+            m_instance.MASTER.BAUD = setting;
+            if(enabled) {
+                m_instance.MASTER.CTRLA.ENABLE = true;
+                set_idle();
+            }
         }
 
         /// sets bus state to idle and clears read and write interrupt flags
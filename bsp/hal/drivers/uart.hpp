@@ -5,6 +5,7 @@
 #endif
 
 #include "device.hpp"       // need this to forward the enum definitions
+#include "drivers/power.hpp"    // peripheral clock gating
 #include "pin_types.hpp"    // for pin type static checks
 #include "nonstd/expected.hpp"     // std::expected implementation for safe return value
 #include "nonstd/span.hpp"         // span for non-owning range based read/write functions
@@ -91,6 +92,15 @@ namespace drivers {
         UART_INSTANCE m_instance;
         RXD_PIN m_rx;
         TXD_PIN m_tx;
+
+        /// CPU cycles of the longest frame (start, 9 data, parity and 2 stop bits) at the current baud setting
+        [[nodiscard]] constexpr uint32_t frame_cycles() const noexcept {
+            const uint8_t ctrlb = m_instance.BAUDCTRLB.read();
+            const uint32_t bsel = (static_cast<uint32_t>(ctrlb & 0x0FU) << 8U) | m_instance.BAUDCTRLA.read();
+            const int8_t bscale = static_cast<int8_t>(ctrlb) >> 4;
+            const uint32_t per_bit = (bscale >= 0) ? (bsel + 1U) << bscale : (bsel >> -bscale) + 1U;
+            return per_bit * (m_instance.CTRLB.CLK2X ? 8U : 16U) * 13U;
+        }
     public:
         constexpr Uart_Basic(const UART_INSTANCE instance, const RXD_PIN rxp, const TXD_PIN txp)
             : m_instance(instance), m_rx(rxp), m_tx(txp)
@@ -100,6 +110,7 @@ namespace drivers {
         constexpr void start(const USART::CHAR_SIZE CharSize = USART::CHAR_SIZE::_8BIT, const USART::PARITY_MODE ParityMode = USART::PARITY_MODE::DISABLED, const bool TwoStopBits = false) const noexcept {
             static_assert(!USART::buad_too_high(CpuFreq, Baud, DoubleSpeed), "Chosen baud rate is too high!");
             static_assert(!USART::buad_too_low(CpuFreq, Baud, DoubleSpeed), "Chosen baud rate is too low!");
+            POWER::enable<UART_INSTANCE>();
             m_instance.BAUDCTRLA = USART::get_baud(CpuFreq, Baud) >> 8U;
             m_instance.BAUDCTRLB = USART::get_baud(CpuFreq, Baud) & 0xFFU;
             m_instance.CTRLB.CLK2X = DoubleSpeed;
@@ -111,8 +122,27 @@ namespace drivers {
             m_instance.CTRLB |= m_instance.CTRLB.TXEN.shift(true) | m_instance.CTRLB.RXEN.shift(true);
         }
 
+        /**
+         * Wait for the last character to be shifted out, then disable the USART and cut its clock.
+         * TXCIF is cleared once the data register is empty and set again when the shift register is. If the
+         * transmitter was idle already it stays clear, so the wait gives up after one frame time.
+         */
         constexpr void stop() const noexcept {
-            m_instance.CTRLB &= ~(m_instance.CTRLB.TXEN.shift(false) | m_instance.CTRLB.RXEN.shift(false));
+            while (!m_instance.STATUS.DREIF) {}
+            m_instance.STATUS = m_instance.STATUS.TXCIF.shift(true);
+            for(uint32_t n = frame_cycles(); n > 0 && !m_instance.STATUS.TXCIF; --n) {}
+            m_instance.CTRLB &= static_cast<uint8_t>(~(m_instance.CTRLB.TXEN.mask | m_instance.CTRLB.RXEN.mask));
+            POWER::disable<UART_INSTANCE>();
+        }
+
+        /**
+         * Change the baud rate setting from USART::get_baud(), for example after the CPU clock changed.
+         * BAUDCTRLA is written last because writing it updates the baud rate generator.
+         * A character in progress is corrupted, so change it between transfers.
+         */
+        constexpr void set_baud(const uint16_t setting) const noexcept {
+            m_instance.BAUDCTRLB = setting & 0xFFU;
+            m_instance.BAUDCTRLA = setting >> 8U;
         }
 
         /**
@@ -0,0 +1,277 @@
+#pragma once
+
+#include "nonstd/expected.hpp"  // std::expected implementation for safe return value
+#include "nonstd/span.hpp"      // span over arena allocations
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed capacity allocators for firmware without a heap. The capacity is a template argument, so all the
+// memory a module can ever use is in its .bss size, and every operation is O(1) with no search or loop.
+// Drivers can share one pool of transaction descriptors or message buffers instead of each reserving for
+// its worst case.
+//
+// Each allocator takes a LOCK type that is constructed around every operation. The default does nothing;
+// pass drivers::CPU::critical_section when an allocator is used from both ISRs and the main loop.
+namespace nonstd {
+
+    namespace alloc {
+        /// list of allocator errors for external consumers.
+        /// Internal implementation (numbers) are NOT stable
+        enum class error : uint8_t {
+            FULL = (1U<<7U),
+            BAD_POINTER = (1U<<6U),
+            NONE = (1U<<0U)
+        };
+
+        /// lock for allocators used from a single context
+        struct no_lock {};
+
+        constexpr size_t align_up(const size_t n, const size_t align) noexcept {
+            return (n + align - 1U) / align * align;
+        }
+
+        /// smallest unsigned type that holds 0 to N
+        template <size_t N>
+        using index_t = std::conditional_t<(N < 0xFFU), uint8_t, uint16_t>;
+
+        /// largest amount in use so far, kept only when TRACK is set so untracked allocators pay nothing
+        template <bool TRACK, typename T>
+        class watermark {
+        protected:
+            constexpr void record(const T) noexcept {}
+            [[nodiscard]] constexpr T peak() const noexcept { return 0; }
+            constexpr void clear_peak() noexcept {}
+        };
+
+        template <typename T>
+        class watermark<true, T> {
+            T m_peak = 0;
+        protected:
+            constexpr void record(const T n) noexcept { if(n > m_peak) { m_peak = n; } }
+            [[nodiscard]] constexpr T peak() const noexcept { return m_peak; }
+            constexpr void clear_peak() noexcept { m_peak = 0; }
+        };
+
+        /// backing memory inside the allocator object
+        template <size_t SIZE, size_t ALIGN>
+        struct internal_storage {
+            static_assert(ALIGN > 0 && (ALIGN & (ALIGN - 1U)) == 0, "Alignment must be a power of two");
+            alignas(ALIGN) uint8_t m_bytes[SIZE];
+            [[nodiscard]] uint8_t* data() noexcept { return m_bytes; }
+            [[nodiscard]] const uint8_t* data() const noexcept { return m_bytes; }
+        };
+    }   // namespace alloc
+
+    /**
+     * Pool of N fixed size blocks. Free blocks are kept in a list threaded through the blocks themselves,
+     * and blocks never used yet are handed out in order, so there is no set up pass and no per block
+     * overhead. Freeing a block twice is not detected.
+     * example: nonstd::block_pool<32, 8> buffers;
+     *          const auto b = buffers.allocate();  ...  buffers.deallocate(*b);
+     * @tparam BLOCK bytes per block, rounded up to the alignment
+     * @tparam ALIGN alignment of every block
+     * @tparam LOCK constructed around each operation, see the top of this file
+     * @tparam TRACK keep the high water mark
+     */
+    template <size_t BLOCK, size_t N, size_t ALIGN = alignof(std::max_align_t), typename LOCK = alloc::no_lock, bool TRACK = false>
+    class block_pool : alloc::watermark<TRACK, alloc::index_t<N>> {
+        static_assert(BLOCK > 0 && N > 0 && N < 0xFFFFU, "A pool needs 1 to 65534 blocks of at least a byte");
+
+        using index = alloc::index_t<N>;
+        static constexpr index END = N;
+
+    public:
+        static constexpr size_t block_size = alloc::align_up(BLOCK < sizeof(index) ? sizeof(index) : BLOCK, ALIGN);
+
+    private:
+        alloc::internal_storage<block_size * N, ALIGN> m_memory;
+        index m_free = END;         // first block of the free list
+        index m_fresh = 0;          // blocks below this have been handed out at least once
+        index m_used = 0;
+
+        [[nodiscard]] uint8_t* block(const index i) noexcept { return m_memory.data() + static_cast<size_t>(i) * block_size; }
+
+    public:
+        /// a block, uninitialized, or FULL
+        [[nodiscard]] nonstd::expected<void*, alloc::error> allocate() noexcept {
+            [[maybe_unused]] LOCK lock;
+            uint8_t* p = nullptr;
+            if(m_free != END) {
+                p = block(m_free);
+                std::memcpy(&m_free, p, sizeof(index));
+            }
+            else if(m_fresh < N) {
+                p = block(m_fresh);
+                ++m_fresh;
+            }
+            else {
+                return nonstd::make_unexpected(alloc::error::FULL);
+            }
+            ++m_used;
+            this->record(m_used);
+            return p;
+        }
+
+        /// return a block, BAD_POINTER if it isn't one from this pool
+        nonstd::expected<void, alloc::error> deallocate(void* const p) noexcept {
+            if(!owns(p)) {
+                return nonstd::make_unexpected(alloc::error::BAD_POINTER);
+            }
+            [[maybe_unused]] LOCK lock;
+            std::memcpy(p, &m_free, sizeof(index));
+            m_free = static_cast<index>((reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(m_memory.data())) / block_size);
+            --m_used;
+            return {};
+        }
+
+        /// true if p is the start of a block of this pool
+        [[nodiscard]] bool owns(const void* const p) const noexcept {
+            const uintptr_t offset = reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(m_memory.data());
+            return offset < static_cast<uintptr_t>(block_size) * m_fresh && offset % block_size == 0;
+        }
+
+        /// forget every block. Blocks still held by users must not be used or returned afterwards.
+        void reset() noexcept {
+            [[maybe_unused]] LOCK lock;
+            m_free = END;
+            m_fresh = 0;
+            m_used = 0;
+            this->clear_peak();
+        }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept { return N; }
+        [[nodiscard]] size_t used() const noexcept { return m_used; }
+        [[nodiscard]] size_t available() const noexcept { return N - m_used; }
+
+        /// most blocks in use at once since the start or reset()
+        [[nodiscard]] size_t high_water() const noexcept {
+            static_assert(TRACK, "The high water mark is only kept with TRACK");
+            return this->peak();
+        }
+    };
+
+    /**
+     * Pool of N objects of type T, constructed on create() and destroyed on destroy().
+     * example: nonstd::object_pool<transfer, 4, drivers::CPU::critical_section> transfers;
+     *          const auto t = transfers.create(address, length);  ...  transfers.destroy(*t);
+     */
+    template <typename T, size_t N, typename LOCK = alloc::no_lock, bool TRACK = false>
+    class object_pool {
+        block_pool<sizeof(T), N, alignof(T), LOCK, TRACK> m_pool;
+
+    public:
+        template <typename... ARGS>
+        [[nodiscard]] nonstd::expected<T*, alloc::error> create(ARGS&&... args) noexcept {
+            const auto p = m_pool.allocate();
+            if(!p) {
+                return nonstd::make_unexpected(p.error());
+            }
+            return new (*p) T(std::forward<ARGS>(args)...);
+        }
+
+        nonstd::expected<void, alloc::error> destroy(T* const p) noexcept {
+            if(!m_pool.owns(p)) {
+                return nonstd::make_unexpected(alloc::error::BAD_POINTER);
+            }
+            p->~T();
+            return m_pool.deallocate(p);
+        }
+
+        [[nodiscard]] bool owns(const T* const p) const noexcept { return m_pool.owns(p); }
+        [[nodiscard]] static constexpr size_t capacity() noexcept { return N; }
+        [[nodiscard]] size_t used() const noexcept { return m_pool.used(); }
+        [[nodiscard]] size_t available() const noexcept { return m_pool.available(); }
+        [[nodiscard]] size_t high_water() const noexcept { return m_pool.high_water(); }
+    };
+
+    /**
+     * Bump allocator. Allocations are never freed one by one: reset() drops all of them, and mark() with
+     * release() rewinds to an earlier point, for scratch space that lives for one batch or one request.
+     * Objects are not destroyed, so make() only takes trivially destructible types.
+     * example: nonstd::arena<512> scratch;
+     *          const auto m = scratch.mark();
+     *          const auto samples = scratch.allocate<int16_t>(96);  ...  scratch.release(m);
+     * @tparam STORAGE where the bytes are, with a data() member; see drivers::ExternalArena
+     */
+    template <size_t SIZE, typename LOCK = alloc::no_lock, bool TRACK = false,
+              typename STORAGE = alloc::internal_storage<SIZE, alignof(std::max_align_t)>>
+    class arena : alloc::watermark<TRACK, size_t> {
+        static_assert(SIZE > 0, "An arena needs at least one byte");
+
+        STORAGE m_memory;
+        size_t m_used = 0;
+
+    public:
+        using marker = size_t;
+
+        /// bytes at an alignment, uninitialized, or FULL
+        [[nodiscard]] nonstd::expected<void*, alloc::error> allocate(const size_t bytes, const size_t align = 1) noexcept {
+            [[maybe_unused]] LOCK lock;
+            const uintptr_t start = reinterpret_cast<uintptr_t>(m_memory.data()) + m_used;
+            const size_t pad = (align - start % align) % align;
+            const size_t room = SIZE - m_used;
+            if(pad > room || bytes > room - pad) {
+                return nonstd::make_unexpected(alloc::error::FULL);
+            }
+            void* const p = m_memory.data() + m_used + pad;
+            m_used += pad + bytes;
+            this->record(m_used);
+            return p;
+        }
+
+        /// room for count objects of T, uninitialized, or FULL
+        template <typename T>
+        [[nodiscard]] nonstd::expected<nonstd::span<T>, alloc::error> allocate(const size_t count) noexcept {
+            if(count > SIZE / sizeof(T)) {
+                return nonstd::make_unexpected(alloc::error::FULL);
+            }
+            const auto p = allocate(count * sizeof(T), alignof(T));
+            if(!p) {
+                return nonstd::make_unexpected(p.error());
+            }
+            return nonstd::span<T>(static_cast<T*>(*p), count);
+        }
+
+        /// construct one object in the arena
+        template <typename T, typename... ARGS>
+        [[nodiscard]] nonstd::expected<T*, alloc::error> make(ARGS&&... args) noexcept {
+            static_assert(std::is_trivially_destructible<T>::value, "Objects in an arena are never destroyed");
+            const auto p = allocate(sizeof(T), alignof(T));
+            if(!p) {
+                return nonstd::make_unexpected(p.error());
+            }
+            return new (*p) T(std::forward<ARGS>(args)...);
+        }
+
+        /// the current fill level, to release() back to
+        [[nodiscard]] marker mark() const noexcept { return m_used; }
+
+        /// drop everything allocated after a mark
+        void release(const marker m) noexcept {
+            [[maybe_unused]] LOCK lock;
+            if(m < m_used) { m_used = m; }
+        }
+
+        /// drop every allocation
+        void reset() noexcept {
+            [[maybe_unused]] LOCK lock;
+            m_used = 0;
+            this->clear_peak();
+        }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept { return SIZE; }
+        [[nodiscard]] size_t used() const noexcept { return m_used; }
+        [[nodiscard]] size_t available() const noexcept { return SIZE - m_used; }
+
+        /// most bytes in use at once since the start or reset()
+        [[nodiscard]] size_t high_water() const noexcept {
+            static_assert(TRACK, "The high water mark is only kept with TRACK");
+            return this->peak();
+        }
+    };
+
+}   // namespace nonstd
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "nonstd/span.hpp"      // span for packed input
+#include <cstddef>
+#include <cstdint>
+
+// Bit level packing for values narrower than a byte or not a whole number of bytes. Values are packed
+// least significant bit first, so a value that straddles bytes starts in the low bits of the first one,
+// and only the last byte of a run of values is padded.
+namespace nonstd::bitpack {
+
+    /// widest value that can be written or read at once
+    inline constexpr uint8_t MAX_WIDTH = 24;
+
+    /// bits needed for an unsigned value, 0 for 0
+    constexpr uint8_t width(uint32_t v) noexcept {
+        uint8_t bits = 0;
+        for(; v != 0; v >>= 1U) { ++bits; }
+        return bits;
+    }
+
+    /// bytes taken by a number of bits
+    constexpr size_t bytes(const size_t bits) noexcept {
+        return (bits + 7U) / 8U;
+    }
+
+    /**
+     * Packs values into a SINK with write(uint8_t), a byte as soon as it is complete.
+     * example: nonstd::bitpack::writer bits(tx);  bits.write(v, 5);  ...  bits.flush();
+     */
+    template <typename SINK>
+    class writer {
+        SINK& m_sink;
+        uint32_t m_bits = 0;    // bits not written out yet, in the low m_count bits
+        uint8_t m_count = 0;
+
+    public:
+        constexpr explicit writer(SINK& sink) noexcept
+            : m_sink(sink)
+        {}
+
+        /// the low width bits of v, up to MAX_WIDTH. Width 0 writes nothing.
+        void write(const uint32_t v, const uint8_t width) noexcept {
+            m_bits |= (v & ((1UL << width) - 1U)) << m_count;
+            m_count += width;
+            while(m_count >= 8U) {
+                m_sink.write(static_cast<uint8_t>(m_bits));
+                m_bits >>= 8U;
+                m_count -= 8U;
+            }
+        }
+
+        /// write out the last partial byte, padded with zeros
+        void flush() noexcept {
+            if(m_count != 0) {
+                m_sink.write(static_cast<uint8_t>(m_bits));
+            }
+            m_bits = 0;
+            m_count = 0;
+        }
+    };
+
+    template <typename SINK>
+    writer(SINK&) -> writer<SINK>;
+
+    /// Unpacks values from the front of a span, the reverse of writer.
+    class reader {
+        nonstd::span<const uint8_t>& m_in;
+        uint32_t m_bits = 0;
+        uint8_t m_count = 0;
+
+    public:
+        /// in is advanced past each byte as it is taken
+        constexpr explicit reader(nonstd::span<const uint8_t>& in) noexcept
+            : m_in(in)
+        {}
+
+        /// read width bits, up to MAX_WIDTH. Returns false if in ends first.
+        bool read(uint32_t& v, const uint8_t width) noexcept {
+            while(m_count < width) {
+                if(m_in.empty()) { return false; }
+                m_bits |= static_cast<uint32_t>(m_in[0]) << m_count;
+                m_in = m_in.subspan(1);
+                m_count += 8U;
+            }
+            v = m_bits & ((1UL << width) - 1U);
+            m_bits >>= width;
+            m_count -= width;
+            return true;
+        }
+
+        /// drop the padding of a partial byte, so in starts at what follows
+        void align() noexcept {
+            m_bits = 0;
+            m_count = 0;
+        }
+    };
+
+}   // namespace nonstd::bitpack
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "nonstd/span.hpp"      // span for non-owning range based functions
+#include <cstdint>
+
+// Small table-free software CRCs for integrity checks on stored and transmitted records.
+// These are constexpr so fixed headers can be checked at compile time, and they behave
+// the same in a simulation build as on hardware.
+namespace nonstd {
+
+    /// CRC-8 with polynomial 0x07, MSB first. Start with 0xFF so runs of 0x00 don't check out.
+    constexpr uint8_t crc8_update(uint8_t crc, const uint8_t data) noexcept {
+        crc ^= data;
+        for(uint8_t i = 0; i < 8; ++i) {
+            crc = (crc & 0x80U) ? static_cast<uint8_t>((crc << 1U) ^ 0x07U) : static_cast<uint8_t>(crc << 1U);
+        }
+        return crc;
+    }
+
+    /// CRC-8 of a range of bytes, continuing from crc
+    constexpr uint8_t crc8(nonstd::span<const uint8_t> data, uint8_t crc = 0xFF) noexcept {
+        for(const uint8_t d : data) {
+            crc = crc8_update(crc, d);
+        }
+        return crc;
+    }
+
+    /// CRC-16/CCITT-FALSE: polynomial 0x1021, MSB first, start with 0xFFFF. Sent high byte first after
+    /// the data it covers, the CRC over data and trailer together is 0.
+    constexpr uint16_t crc16_update(uint16_t crc, const uint8_t data) noexcept {
+        crc ^= static_cast<uint16_t>(data) << 8U;
+        for(uint8_t i = 0; i < 8; ++i) {
+            crc = (crc & 0x8000U) ? static_cast<uint16_t>((crc << 1U) ^ 0x1021U) : static_cast<uint16_t>(crc << 1U);
+        }
+        return crc;
+    }
+
+    /// CRC-16 of a range of bytes, continuing from crc
+    constexpr uint16_t crc16(nonstd::span<const uint8_t> data, uint16_t crc = 0xFFFF) noexcept {
+        for(const uint8_t d : data) {
+            crc = crc16_update(crc, d);
+        }
+        return crc;
+    }
+
+}   // namespace nonstd
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "nonstd/span.hpp"      // span for bulk and zero copy access
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if SIMULATION_BUILD
+#include <atomic>
+#endif
+
+// Single producer, single consumer queues for handing data between an ISR and the main loop without
+// disabling interrupts. The producer only writes the head and the consumer only writes the tail, and each
+// side publishes its index after the data it covers, so neither side ever waits on or locks out the other.
+namespace nonstd {
+
+    namespace ring {
+        /// smallest index type that counts to 2 * N, so full and empty differ. 8-bit indices are read and
+        /// written in one instruction on the AVR.
+        template <size_t N>
+        using index_t = std::conditional_t<(N <= 128U), uint8_t, uint16_t>;
+
+        /// keep the compiler, and the host CPU in a simulation build, from moving accesses across a publish
+        inline void barrier() noexcept {
+#if SIMULATION_BUILD
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+#else
+            asm volatile("" ::: "memory");
+#endif
+        }
+
+        /// store an index the other side reads. A 16-bit index is stored with interrupts disabled, so an ISR
+        /// reading it never sees one byte of the new value and one of the old.
+        template <typename I>
+        inline void store(volatile I& i, const I value) noexcept {
+            barrier();
+            if constexpr (sizeof(I) == 1) {
+                i = value;
+            }
+            else {
+#if SIMULATION_BUILD
+                i = value;
+#else
+                uint8_t sreg;
+                asm volatile("in %0, __SREG__" "\n\t" "cli" : "=r"(sreg) :: "memory");
+                i = value;
+                asm volatile("out __SREG__, %0" :: "r"(sreg) : "memory");
+#endif
+            }
+        }
+    }   // namespace ring
+
+    /**
+     * Lock free ring buffer between one producer and one consumer, for example a receive ISR and the main
+     * loop. The producer uses push(), push_all(), reserve() and commit(); the consumer uses pop(), peek(),
+     * consume() and clear(). size() and empty() can be called from either side.
+     *
+     * The indices run freely and are masked on access, so all N elements are used. Bulk copies are done in
+     * at most two memcpy calls, one up to the end of the buffer and one from its start. reserve() and peek()
+     * give the contiguous free or filled part in place, for a DMA transfer or a parser that doesn't copy.
+     *
+     * With N up to 128 the indices are single bytes, which the AVR accesses atomically. Above that each side
+     * stores its 16-bit index with interrupts disabled for the two instructions of the store, and reads the
+     * other side's index until two reads agree. Neither side ever waits for the other, so it stays lock free.
+     * example: nonstd::spsc_ring<uint8_t, 64> rx;     // ISR: rx.push(data);  main: while(rx.pop(c)) { ... }
+     * @tparam N capacity, a power of two up to 32768
+     */
+    template <typename T, size_t N>
+    class spsc_ring {
+        static_assert(N >= 2 && N <= 32'768U && (N & (N - 1U)) == 0, "Ring capacity must be a power of two from 2 to 32768");
+        static_assert(std::is_trivially_copyable<T>::value, "Ring elements are copied with memcpy");
+
+        using index = ring::index_t<N>;
+        static constexpr index MASK = N - 1U;
+
+        std::array<T, N> m_buffer{};
+        volatile index m_head = 0;      // written by the producer only
+        volatile index m_tail = 0;      // written by the consumer only
+
+        /// read an index the other side may be changing. The barrier keeps the data accesses it covers
+        /// from being moved before it.
+        [[nodiscard]] static index load(const volatile index& i) noexcept {
+            index value = i;
+            if constexpr (sizeof(index) != 1) {
+                for(index again = i; again != value; again = i) { value = again; }
+            }
+            ring::barrier();
+            return value;
+        }
+
+        [[nodiscard]] size_t free_space() const noexcept { return N - static_cast<index>(m_head - load(m_tail)); }
+        [[nodiscard]] size_t filled() const noexcept { return static_cast<index>(load(m_head) - m_tail); }
+
+        /// copy into the buffer from a position, wrapping at the end
+        void copy_in(const index at, nonstd::span<const T> data) noexcept {
+            const size_t start = at & MASK;
+            const size_t first = (data.size() < N - start) ? data.size() : N - start;
+            std::memcpy(&m_buffer[start], data.data(), first * sizeof(T));
+            std::memcpy(&m_buffer[0], data.data() + first, (data.size() - first) * sizeof(T));
+        }
+
+        void copy_out(const index at, nonstd::span<T> data) const noexcept {
+            const size_t start = at & MASK;
+            const size_t first = (data.size() < N - start) ? data.size() : N - start;
+            std::memcpy(data.data(), &m_buffer[start], first * sizeof(T));
+            std::memcpy(data.data() + first, &m_buffer[0], (data.size() - first) * sizeof(T));
+        }
+
+        void publish_head(const index head) noexcept { ring::store(m_head, head); }
+        void publish_tail(const index tail) noexcept { ring::store(m_tail, tail); }
+
+    public:
+        using value_type = T;
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept { return N; }
+        [[nodiscard]] size_t size() const noexcept { return static_cast<index>(load(m_head) - load(m_tail)); }
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+        [[nodiscard]] bool full() const noexcept { return size() == N; }
+
+        // producer side
+
+        /// add one element. Returns false if the ring is full.
+        bool push(const T& value) noexcept {
+            const index head = m_head;
+            if(static_cast<index>(head - load(m_tail)) == N) { return false; }
+            m_buffer[head & MASK] = value;
+            publish_head(static_cast<index>(head + 1U));
+            return true;
+        }
+
+        /// add as many elements as fit. Returns the number added.
+        size_t push(nonstd::span<const T> data) noexcept {
+            const size_t room = free_space();
+            const size_t count = (data.size() < room) ? data.size() : room;
+            copy_in(m_head, data.first(count));
+            publish_head(static_cast<index>(m_head + count));
+            return count;
+        }
+
+        /// add both ranges or nothing, so the consumer sees them together, for example a header and a payload
+        bool push_all(nonstd::span<const T> first, nonstd::span<const T> second = {}) noexcept {
+            if(first.size() + second.size() > free_space()) { return false; }
+            const index head = m_head;
+            copy_in(head, first);
+            copy_in(static_cast<index>(head + first.size()), second);
+            publish_head(static_cast<index>(head + first.size() + second.size()));
+            return true;
+        }
+
+        /// the free space up to the end of the buffer, to fill in place and then commit()
+        [[nodiscard]] nonstd::span<T> reserve() noexcept {
+            const size_t start = m_head & MASK;
+            const size_t room = free_space();
+            return { &m_buffer[start], (room < N - start) ? room : N - start };
+        }
+
+        /// make count elements written through reserve() visible to the consumer
+        void commit(const size_t count) noexcept {
+            publish_head(static_cast<index>(m_head + count));
+        }
+
+        // consumer side
+
+        /// take one element. Returns false if the ring is empty.
+        bool pop(T& value) noexcept {
+            const index tail = m_tail;
+            if(load(m_head) == tail) { return false; }
+            value = m_buffer[tail & MASK];
+            publish_tail(static_cast<index>(tail + 1U));
+            return true;
+        }
+
+        /// take as many elements as are there and fit. Returns the number taken.
+        size_t pop(nonstd::span<T> data) noexcept {
+            const size_t available = filled();
+            const size_t count = (data.size() < available) ? data.size() : available;
+            copy_out(m_tail, data.first(count));
+            publish_tail(static_cast<index>(m_tail + count));
+            return count;
+        }
+
+        /// copy elements starting offset places from the front without taking them. Returns false if they aren't all there.
+        bool peek(nonstd::span<T> data, const size_t offset = 0) const noexcept {
+            if(offset + data.size() > filled()) { return false; }
+            copy_out(static_cast<index>(m_tail + offset), data);
+            return true;
+        }
+
+        /// the filled part up to the end of the buffer, to read in place and then consume()
+        [[nodiscard]] nonstd::span<const T> peek() const noexcept {
+            const size_t start = m_tail & MASK;
+            const size_t available = filled();
+            return { &m_buffer[start], (available < N - start) ? available : N - start };
+        }
+
+        /// drop count elements from the front, after reading them through peek()
+        void consume(const size_t count) noexcept {
+            publish_tail(static_cast<index>(m_tail + count));
+        }
+
+        /// drop everything that is in the ring
+        void clear() noexcept {
+            publish_tail(load(m_head));
+        }
+    };
+
+    /// byte stream, for example the receive and transmit buffers of a serial port
+    template <size_t N>
+    using byte_ring = spsc_ring<uint8_t, N>;
+
+    /**
+     * Queue of variable length messages of 1 to 255 bytes, stored with a length byte in a byte ring.
+     * A message is published whole, so the consumer never sees part of one. Empty messages are refused,
+     * so a 0 from receive() always means there was nothing to take.
+     * example: nonstd::spsc_message_queue<256> events;
+     *          ISR: events.send(frame);  main: std::array<uint8_t, 32> m; while(const auto n = events.receive(m)) { ... }
+     */
+    template <size_t N>
+    class spsc_message_queue {
+        byte_ring<N> m_ring;
+
+    public:
+        static constexpr size_t MAX_MESSAGE = (N - 1U < 255U) ? N - 1U : 255U;
+
+        /// queue a message. Returns false if it is empty, too long, or doesn't fit now.
+        bool send(nonstd::span<const uint8_t> message) noexcept {
+            if(message.empty() || message.size() > MAX_MESSAGE) { return false; }
+            const auto length = static_cast<uint8_t>(message.size());
+            return m_ring.push_all({ &length, 1 }, message);
+        }
+
+        /// length of the next message, or -1 if there is none
+        [[nodiscard]] int16_t next_size() const noexcept {
+            uint8_t length = 0;
+            if(!m_ring.peek({ &length, 1 })) { return -1; }
+            return length;
+        }
+
+        /**
+         * Take the next message.
+         * @param message [OUT] receives the message. A message that doesn't fit is left in the queue.
+         * @return the message length, 0 for no message or one that doesn't fit, see next_size()
+         */
+        size_t receive(nonstd::span<uint8_t> message) noexcept {
+            const int16_t length = next_size();
+            if(length < 0 || static_cast<size_t>(length) > message.size()) { return 0; }
+            m_ring.consume(1);
+            return m_ring.pop(message.first(static_cast<size_t>(length)));
+        }
+
+        /// drop the next message
+        void skip() noexcept {
+            const int16_t length = next_size();
+            if(length >= 0) { m_ring.consume(1U + static_cast<size_t>(length)); }
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return m_ring.empty(); }
+        void clear() noexcept { m_ring.clear(); }
+    };
+
+}   // namespace nonstd
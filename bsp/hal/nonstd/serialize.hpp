@@ -0,0 +1,276 @@
+#pragma once
+
+#include "nonstd/expected.hpp"  // std::expected implementation for safe return value
+#include "nonstd/span.hpp"      // span for batches and buffers
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Compile time schemas for packing structs into compact binary records. A schema lists the members of a
+// struct and how each is encoded; write() and read() unroll into straight line code for exactly those
+// fields, with no field tags or type information on the wire. Records go to any SINK with write(uint8_t),
+// for example a nonstd::slip::encoder, so a batch is serialized straight into a frame.
+//
+// A schema can also write a descriptor of itself, which scripts/telemetry_decode.py uses to decode
+// batches without a copy of the schema on the host.
+namespace nonstd::serialize {
+
+    /// list of serialization errors for external consumers.
+    /// Internal implementation (numbers) are NOT stable
+    enum class error : uint8_t {
+        TRUNCATED = (1U<<7U),
+        WRONG_SCHEMA = (1U<<6U),
+        TOO_MANY = (1U<<5U),
+        NONE = (1U<<0U)
+    };
+
+    enum class encoding : uint8_t {
+        FIXED = 0,      // little endian, the size of the member
+        VARINT = 1,     // unsigned LEB128, 7 bits per byte
+        ZIGZAG = 2,     // signed values mapped to unsigned, small magnitudes first, then VARINT
+        DELTA = 3       // ZIGZAG of the difference from the same member of the record before
+    };
+
+    /// first byte of a descriptor, schema ids start at 1
+    inline constexpr uint8_t DESCRIPTOR = 0;
+    /// ids from here up are left for frames that aren't schema batches
+    inline constexpr uint8_t RESERVED = 0xF0;
+
+    /// bytes a varint of a number of bits can take
+    constexpr uint8_t varint_max(const size_t bits) noexcept {
+        return static_cast<uint8_t>((bits + 6U) / 7U);
+    }
+
+    template <typename T>
+    constexpr std::make_unsigned_t<T> zigzag(const T v) noexcept {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<U>((static_cast<U>(v) << 1U) ^ static_cast<U>(v < 0 ? ~U{0} : U{0}));
+    }
+
+    template <typename U>
+    constexpr std::make_signed_t<U> unzigzag(const U v) noexcept {
+        return static_cast<std::make_signed_t<U>>((v >> 1U) ^ (~(v & 1U) + 1U));
+    }
+
+    template <typename SINK, typename U>
+    void put_varint(SINK& sink, U v) noexcept {
+        static_assert(std::is_unsigned<U>::value, "Varints are unsigned, zigzag signed values first");
+        while(v >= 0x80U) {
+            sink.write(static_cast<uint8_t>(v | 0x80U));
+            v >>= 7U;
+        }
+        sink.write(static_cast<uint8_t>(v));
+    }
+
+    /// read a varint from the front of in and advance past it. Returns false if in ends first, or the varint
+    /// is longer than U takes or holds a value wider than U.
+    template <typename U>
+    bool get_varint(nonstd::span<const uint8_t>& in, U& v) noexcept {
+        static_assert(std::is_unsigned<U>::value, "Varints are unsigned, zigzag signed values first");
+        constexpr uint8_t WIDTH = sizeof(U) * 8U;
+        v = 0;
+        for(uint8_t shift = 0; shift < WIDTH; shift += 7U) {
+            if(in.empty()) { return false; }
+            const uint8_t b = in[0];
+            in = in.subspan(1);
+            const uint8_t bits = b & 0x7FU;
+            // the last byte may only carry the bits that are left of U
+            if(shift + 7U > WIDTH && (bits >> (WIDTH - shift)) != 0) { return false; }
+            v |= static_cast<U>(static_cast<U>(bits) << shift);
+            if(!(b & 0x80U)) { return true; }
+        }
+        // still continuing after all the bits of U, too long
+        return false;
+    }
+
+    template <typename T>
+    struct member_traits;
+    template <typename C, typename M>
+    struct member_traits<M C::*> {
+        using owner = C;
+        using type = M;
+    };
+
+    /**
+     * One member of a schema.
+     * @tparam MEMBER pointer to the member, for example &peripheral::ThreeAxis::x
+     * @tparam E how the member is encoded
+     */
+    template <auto MEMBER, encoding E = encoding::FIXED>
+    struct field {
+        using type = typename member_traits<decltype(MEMBER)>::type;
+        static_assert(std::is_integral<type>::value && sizeof(type) <= 4, "Fields are integers of up to 32 bits");
+        static_assert(E != encoding::VARINT || std::is_unsigned<type>::value, "VARINT fields are unsigned, use ZIGZAG for signed ones");
+
+        static constexpr bool is_signed = std::is_signed<type>::value;
+        /// differences need one more bit than the values, so they are taken in a wider type
+        using wide = std::conditional_t<(sizeof(type) < 4), int32_t, int64_t>;
+
+        static constexpr uint8_t max_size =
+            E == encoding::FIXED ? sizeof(type)
+          : E == encoding::DELTA ? varint_max(sizeof(type) * 8U + 2U)
+          : varint_max(sizeof(type) * 8U);
+        /// encoding, signedness and size, see scripts/telemetry_decode.py
+        static constexpr uint8_t descriptor = static_cast<uint8_t>((static_cast<uint8_t>(E) << 5U) | (is_signed ? 0x10U : 0U) | sizeof(type));
+
+        template <typename SINK, typename R>
+        static void write(SINK& sink, const R& record, const R& previous) noexcept {
+            const type v = record.*MEMBER;
+            if constexpr (E == encoding::FIXED) {
+                using U = std::make_unsigned_t<type>;
+                for(uint8_t i = 0; i < sizeof(type); ++i) {
+                    sink.write(static_cast<uint8_t>(static_cast<U>(v) >> (8U * i)));
+                }
+            }
+            else if constexpr (E == encoding::VARINT) {
+                put_varint(sink, v);
+            }
+            else if constexpr (E == encoding::ZIGZAG) {
+                put_varint(sink, zigzag(static_cast<wide>(v)));
+            }
+            else {
+                put_varint(sink, zigzag(static_cast<wide>(static_cast<wide>(v) - static_cast<wide>(previous.*MEMBER))));
+            }
+        }
+
+        template <typename R>
+        static bool read(nonstd::span<const uint8_t>& in, R& record, const R& previous) noexcept {
+            if constexpr (E == encoding::FIXED) {
+                if(in.size() < sizeof(type)) { return false; }
+                std::make_unsigned_t<type> v = 0;
+                for(uint8_t i = 0; i < sizeof(type); ++i) {
+                    v |= static_cast<std::make_unsigned_t<type>>(static_cast<std::make_unsigned_t<type>>(in[i]) << (8U * i));
+                }
+                in = in.subspan(sizeof(type));
+                record.*MEMBER = static_cast<type>(v);
+                return true;
+            }
+            else if constexpr (E == encoding::VARINT) {
+                return get_varint(in, record.*MEMBER);
+            }
+            else {
+                std::make_unsigned_t<wide> v = 0;
+                if(!get_varint(in, v)) { return false; }
+                const wide base = (E == encoding::DELTA) ? static_cast<wide>(previous.*MEMBER) : 0;
+                record.*MEMBER = static_cast<type>(base + unzigzag(v));
+                return true;
+            }
+        }
+    };
+
+    /**
+     * A record layout. A batch is the schema id, the record count as a varint, then the records; DELTA
+     * fields of the first record are relative to zero.
+     * example: using sample = nonstd::serialize::schema<1, field<&ThreeAxis::x, encoding::DELTA>, ...>;
+     *          sample::describe(tx);  ...  sample::write_batch(tx, nonstd::span<const Acceleration>(buf.data(), n));
+     * @tparam ID identifies the schema on the wire, 1-239
+     */
+    template <uint8_t ID, typename... FIELDS>
+    struct schema {
+        static_assert(ID != DESCRIPTOR, "Schema id 0 marks descriptors");
+        static_assert(ID < RESERVED, "Schema ids from 0xF0 are reserved");
+        static_assert(sizeof...(FIELDS) > 0 && sizeof...(FIELDS) < 256U, "A schema has 1 to 255 fields");
+
+        static constexpr uint8_t id = ID;
+        static constexpr size_t max_record_size = (static_cast<size_t>(FIELDS::max_size) + ...);
+        static constexpr std::array<uint8_t, sizeof...(FIELDS)> descriptors = { FIELDS::descriptor... };
+
+        /// largest batch of count records
+        static constexpr size_t max_batch_size(const size_t count) noexcept {
+            return 1U + varint_max(16) + count * max_record_size;
+        }
+
+        /// DESCRIPTOR, the id, the field count, and a byte per field
+        template <typename SINK>
+        static void describe(SINK& sink) noexcept {
+            sink.write(DESCRIPTOR);
+            sink.write(ID);
+            sink.write(static_cast<uint8_t>(sizeof...(FIELDS)));
+            for(const uint8_t d : descriptors) { sink.write(d); }
+        }
+
+        template <typename SINK, typename R>
+        static void write(SINK& sink, const R& record, const R& previous) noexcept {
+            (FIELDS::write(sink, record, previous), ...);
+        }
+
+        template <typename R>
+        static bool read(nonstd::span<const uint8_t>& in, R& record, const R& previous) noexcept {
+            return (FIELDS::read(in, record, previous) && ...);
+        }
+
+        /**
+         * Pack a batch.
+         * @param sink [OUT] receives the batch
+         * @param records [IN] the records, at most 65535 since the count is a 16-bit varint
+         * @return the number of records, or TOO_MANY with nothing written
+         */
+        template <typename SINK, typename R>
+        [[nodiscard]] static nonstd::expected<size_t, error> write_batch(SINK& sink, nonstd::span<const R> records) noexcept {
+            if(records.size() > UINT16_MAX) {
+                return nonstd::make_unexpected(error::TOO_MANY);
+            }
+            sink.write(ID);
+            put_varint(sink, static_cast<uint16_t>(records.size()));
+            R previous{};
+            for(const R& r : records) {
+                write(sink, r, previous);
+                previous = r;
+            }
+            return records.size();
+        }
+
+        /**
+         * Unpack a batch.
+         * @param in [IN] the batch, starting with the schema id
+         * @param out [OUT] the records
+         * @return the number of records
+         */
+        template <typename R>
+        static nonstd::expected<size_t, error> read_batch(nonstd::span<const uint8_t> in, nonstd::span<R> out) noexcept {
+            if(in.empty() || in[0] != ID) {
+                return nonstd::make_unexpected(error::WRONG_SCHEMA);
+            }
+            in = in.subspan(1);
+            uint16_t count = 0;
+            if(!get_varint(in, count)) {
+                return nonstd::make_unexpected(error::TRUNCATED);
+            }
+            if(count > out.size()) {
+                return nonstd::make_unexpected(error::TOO_MANY);
+            }
+            R previous{};
+            for(uint16_t i = 0; i < count; ++i) {
+                if(!read(in, out[i], previous)) {
+                    return nonstd::make_unexpected(error::TRUNCATED);
+                }
+                previous = out[i];
+            }
+            return count;
+        }
+    };
+
+    /// SINK over a byte buffer. Bytes past the end are counted but dropped, check ok().
+    class buffer_writer {
+        nonstd::span<uint8_t> m_buffer;
+        size_t m_length = 0;
+
+    public:
+        constexpr explicit buffer_writer(nonstd::span<uint8_t> buffer) noexcept
+            : m_buffer(buffer)
+        {}
+
+        constexpr void write(const uint8_t b) noexcept {
+            if(m_length < m_buffer.size()) { m_buffer[m_length] = b; }
+            ++m_length;
+        }
+
+        [[nodiscard]] constexpr bool ok() const noexcept { return m_length <= m_buffer.size(); }
+        [[nodiscard]] constexpr nonstd::span<const uint8_t> data() const noexcept {
+            return m_buffer.first(ok() ? m_length : m_buffer.size());
+        }
+        constexpr void clear() noexcept { m_length = 0; }
+    };
+
+}   // namespace nonstd::serialize
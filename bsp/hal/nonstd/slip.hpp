@@ -0,0 +1,213 @@
+#pragma once
+
+#include "nonstd/crc.hpp"       // frame check trailer
+#include "nonstd/expected.hpp"  // std::expected implementation for safe return value
+#include "nonstd/span.hpp"      // span for payloads
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// SLIP framing (RFC 1055) with an optional CRC-16 trailer, for binary packets over a serial line.
+// SLIP escapes byte by byte with no look ahead, so frames are encoded straight into the transmit path,
+// a Uart_Basic or a nonstd::byte_ring, and decoded straight out of the receive path, without a copy of the
+// whole frame. A frame is END, the escaped payload and CRC, END; the leading END flushes line noise.
+namespace nonstd::slip {
+
+    /// list of SLIP errors for external consumers.
+    /// Internal implementation (numbers) are NOT stable
+    enum class error : uint8_t {
+        TOO_LONG = (1U<<7U),
+        BAD_CRC = (1U<<6U),
+        BAD_ESCAPE = (1U<<5U),
+        PENDING = (1U<<1U),      // no complete frame yet
+        NONE = (1U<<0U)
+    };
+
+    inline constexpr uint8_t END = 0xC0;
+    inline constexpr uint8_t ESC = 0xDB;
+    inline constexpr uint8_t ESC_END = 0xDC;
+    inline constexpr uint8_t ESC_ESC = 0xDD;
+    inline constexpr uint8_t CRC_SIZE = 2;
+
+    /// most bytes a payload can take on the wire, every byte escaped
+    constexpr size_t max_encoded_size(const size_t payload, const bool crc = true) noexcept {
+        return 2U + 2U * (payload + (crc ? CRC_SIZE : 0U));
+    }
+
+    /// sinks are written with push() if they have it, like a ring, or put(), like a Uart_Basic
+    template <typename SINK, typename = void>
+    struct has_push : std::false_type {};
+    template <typename SINK>
+    struct has_push<SINK, std::void_t<decltype(std::declval<SINK&>().push(uint8_t{}))>> : std::true_type {};
+
+    /**
+     * Streaming frame encoder. Payload bytes are escaped and written to the sink as they are given, so a
+     * frame can be built from several writes with nothing buffered.
+     * A ring sink that fills up mid frame makes end() return false; check for max_encoded_size() free
+     * first to never split a frame. A put() sink like Uart_Basic waits instead.
+     * example: nonstd::slip::encoder tx(board::EDBG_VCOM);
+     *          tx.begin();  tx.write(header);  tx.write(samples);  tx.end();
+     * @tparam CRC append a CRC-16 trailer
+     */
+    template <typename SINK, bool CRC = true>
+    class encoder {
+        SINK& m_sink;
+        uint16_t m_crc = 0xFFFF;
+        bool m_ok = true;
+
+        void emit(const uint8_t b) noexcept {
+            if constexpr (has_push<SINK>::value) { m_ok = m_sink.push(b) && m_ok; }
+            else { m_sink.put(b); }
+        }
+
+        void escape(const uint8_t b) noexcept {
+            if(b == END) { emit(ESC); emit(ESC_END); }
+            else if(b == ESC) { emit(ESC); emit(ESC_ESC); }
+            else { emit(b); }
+        }
+
+    public:
+        constexpr explicit encoder(SINK& sink) noexcept
+            : m_sink(sink)
+        {}
+
+        void begin() noexcept {
+            m_crc = 0xFFFF;
+            m_ok = true;
+            emit(END);
+        }
+
+        void write(const uint8_t b) noexcept {
+            if constexpr (CRC) { m_crc = crc16_update(m_crc, b); }
+            escape(b);
+        }
+
+        void write(nonstd::span<const uint8_t> data) noexcept {
+            for(const uint8_t b : data) { write(b); }
+        }
+
+        /// finish the frame. Returns false if the sink ran out of room during it.
+        bool end() noexcept {
+            if constexpr (CRC) {
+                const uint16_t crc = m_crc;
+                escape(static_cast<uint8_t>(crc >> 8U));
+                escape(static_cast<uint8_t>(crc));
+            }
+            emit(END);
+            return m_ok;
+        }
+
+        /// a whole frame in one call
+        bool send(nonstd::span<const uint8_t> payload) noexcept {
+            begin();
+            write(payload);
+            return end();
+        }
+    };
+
+    template <typename SINK>
+    encoder(SINK&) -> encoder<SINK>;
+
+    /**
+     * Streaming frame decoder into a buffer of MAX payload bytes. Bytes are fed one at a time from an ISR
+     * or a blocking read, or drained from a receive ring with poll(). A completed frame stays valid until
+     * the next byte is fed. Frames that are too long, badly escaped or fail the CRC are dropped up to the
+     * next END, so the decoder resynchronizes on its own.
+     * example: nonstd::slip::decoder<64> rx;
+     *          const auto frame = rx.poll(rx_ring);  if(frame) { handle(*frame); }
+     * @tparam MAX largest payload, not counting the CRC
+     * @tparam CRC check and strip a CRC-16 trailer
+     */
+    template <size_t MAX, bool CRC = true>
+    class decoder {
+        static constexpr size_t BUFFER = MAX + (CRC ? CRC_SIZE : 0U);
+
+        std::array<uint8_t, BUFFER> m_buffer{};
+        size_t m_length = 0;
+        uint16_t m_crc = 0xFFFF;
+        bool m_escape = false;
+        error m_drop = error::NONE;     // the frame is being skipped up to the next END, and why
+
+        void restart() noexcept {
+            m_length = 0;
+            m_crc = 0xFFFF;
+            m_escape = false;
+            m_drop = error::NONE;
+        }
+
+        [[nodiscard]] nonstd::expected<nonstd::span<const uint8_t>, error> finish() noexcept {
+            const error drop = m_drop;
+            const size_t length = m_length;
+            const uint16_t crc = m_crc;
+            restart();
+            if(drop != error::NONE) {
+                return nonstd::make_unexpected(drop);
+            }
+            if(length == 0) {
+                return nonstd::make_unexpected(error::PENDING);     // back to back ENDs
+            }
+            if constexpr (CRC) {
+                if(length < CRC_SIZE || crc != 0) {
+                    return nonstd::make_unexpected(error::BAD_CRC);
+                }
+                return nonstd::span<const uint8_t>(m_buffer.data(), length - CRC_SIZE);
+            }
+            else {
+                return nonstd::span<const uint8_t>(m_buffer.data(), length);
+            }
+        }
+
+    public:
+        /// feed one received byte. Returns the payload when a frame ends, PENDING in the middle of one.
+        [[nodiscard]] nonstd::expected<nonstd::span<const uint8_t>, error> feed(uint8_t b) noexcept {
+            if(b == END) {
+                return finish();
+            }
+            if(m_drop != error::NONE) {
+                return nonstd::make_unexpected(error::PENDING);
+            }
+            if(m_escape) {
+                m_escape = false;
+                if(b == ESC_END) { b = END; }
+                else if(b == ESC_ESC) { b = ESC; }
+                else {
+                    m_drop = error::BAD_ESCAPE;
+                    return nonstd::make_unexpected(error::PENDING);
+                }
+            }
+            else if(b == ESC) {
+                m_escape = true;
+                return nonstd::make_unexpected(error::PENDING);
+            }
+            if(m_length == BUFFER) {
+                m_drop = error::TOO_LONG;
+                return nonstd::make_unexpected(error::PENDING);
+            }
+            m_buffer[m_length++] = b;
+            if constexpr (CRC) { m_crc = crc16_update(m_crc, b); }
+            return nonstd::make_unexpected(error::PENDING);
+        }
+
+        /**
+         * Drain a receive ring up to the end of a frame, or until it is empty.
+         * @return the payload, PENDING if the ring ran dry first, or why a frame was dropped
+         */
+        template <typename RING>
+        [[nodiscard]] nonstd::expected<nonstd::span<const uint8_t>, error> poll(RING& rx) noexcept {
+            uint8_t b = 0;
+            while(rx.pop(b)) {
+                const auto frame = feed(b);
+                if(frame || frame.error() != error::PENDING) {
+                    return frame;
+                }
+            }
+            return nonstd::make_unexpected(error::PENDING);
+        }
+
+        /// drop a partly received frame
+        void reset() noexcept { restart(); }
+    };
+
+}   // namespace nonstd::slip
@@ -55,20 +55,35 @@ void* ucpp::registers::sim::get_mem_address(const uint32_t addr) noexcept {
     return nullptr;
 }
 
+// multi-byte registers are little endian, like the XMEGA
 template<typename T>
 T ucpp::registers::sim::read(const uint32_t addr) noexcept {
-    const T value = mm.read8(addr);
-    std::printf("Read:  0x%08X as 0x%02X\n", addr, value);
+    T value = 0;
+    for(uint32_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(mm.read8(addr + i)) << (8U * i);
+    }
+    const int width = 2 * sizeof(T);
+    std::printf("Read:  0x%08X as 0x%0*X\n", addr, width, static_cast<unsigned>(value));
     fflush(stdout);
     return value;
 }
 
 template<typename T>
 void ucpp::registers::sim::write(const uint32_t addr, const T val) noexcept {
-    std::printf("Write: 0x%08X, 0x%02X --> 0x%02X\n", addr, mm.read8(addr), val);
+    T old = 0;
+    for(uint32_t i = 0; i < sizeof(T); ++i) {
+        old |= static_cast<T>(mm.read8(addr + i)) << (8U * i);
+    }
+    const int width = 2 * sizeof(T);
+    std::printf("Write: 0x%08X, 0x%0*X --> 0x%0*X\n", addr, width, static_cast<unsigned>(old), width, static_cast<unsigned>(val));
     fflush(stdout);
-    mm.write8(addr, val);
+    // the low byte is always written first
+    for(uint32_t i = 0; i < sizeof(T); ++i) {
+        mm.write8(addr + i, static_cast<uint8_t>(val >> (8U * i)));
+    }
 }
 
 template void ucpp::registers::sim::write<uint8_t>(const uint32_t addr, const uint8_t val) noexcept;
 template uint8_t ucpp::registers::sim::read<uint8_t>(const uint32_t addr) noexcept;
+template void ucpp::registers::sim::write<uint16_t>(const uint32_t addr, const uint16_t val) noexcept;
+template uint16_t ucpp::registers::sim::read<uint16_t>(const uint32_t addr) noexcept;
@@ -0,0 +1,120 @@
+// Known answer check of AES_Basic against the FIPS-197 appendix C.1 example and the NIST SP 800-38A
+// AES-128 vectors for ECB (F.1.1), CBC (F.2.1) and CTR (F.5.1). The simulation build runs the bit exact
+// software model of the module, including the decryption from the last subkey.
+#include "drivers/aes.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    using drivers::AES::block;
+
+    constexpr drivers::AES_Basic aes(device::AES);
+
+    constexpr uint8_t nibble(const char c) {
+        return (c <= '9') ? c - '0' : c - 'a' + 10;
+    }
+
+    /// bytes from a hex string
+    std::vector<uint8_t> hex(const char* s) {
+        std::vector<uint8_t> bytes;
+        for(; s[0] && s[1]; s += 2) { bytes.push_back(static_cast<uint8_t>((nibble(s[0]) << 4U) | nibble(s[1]))); }
+        return bytes;
+    }
+
+    block to_block(const char* s) {
+        const auto bytes = hex(s);
+        block b{};
+        std::memcpy(b.data(), bytes.data(), b.size());
+        return b;
+    }
+
+    bool expect(const char* name, const std::vector<uint8_t>& got, const std::vector<uint8_t>& want) {
+        if(got == want) { return true; }
+        std::printf("%s: mismatch\n", name);
+        return false;
+    }
+
+    const auto sp800_key = to_block("2b7e151628aed2a6abf7158809cf4f3c");
+    const auto sp800_plain = hex("6bc1bee22e409f96e93d7e117393172a" "ae2d8a571e03ac9c9eb76fac45af8e51"
+                                 "30c81c46a35ce411e5fbc1191a0a52ef" "f69f2445df4f9b17ad2b417be66c3710");
+
+    bool fips197() {
+        const auto ks = aes.make_key_schedule(to_block("000102030405060708090a0b0c0d0e0f"));
+        block data = to_block("00112233445566778899aabbccddeeff");
+        bool ok = ks && aes.encrypt(*ks, data);
+        ok = ok && expect("fips-197 encrypt", { data.begin(), data.end() }, hex("69c4e0d86a7b0430d8cdb78070b4c55a"));
+        ok = ok && aes.decrypt(*ks, data);
+        return ok && expect("fips-197 decrypt", { data.begin(), data.end() }, hex("00112233445566778899aabbccddeeff"));
+    }
+
+    bool ecb() {
+        const auto cipher = hex("3ad77bb40d7a3660a89ecaf32466ef97" "f5d3d58503b9699de785895a96fdbaaf"
+                                "43b1cd7f598ece23881b00e3ed030688" "7b0c785e27e8ad3f8223207104725dd4");
+        const auto ks = aes.make_key_schedule(sp800_key);
+        auto data = sp800_plain;
+        bool ok = ks && aes.ecb_encrypt(*ks, data) && expect("ecb encrypt", data, cipher);
+        return ok && aes.ecb_decrypt(*ks, data) && expect("ecb decrypt", data, sp800_plain);
+    }
+
+    bool cbc() {
+        const auto cipher = hex("7649abac8119b246cee98e9b12e9197d" "5086cb9b507219ee95db113a917678b2"
+                                "73bed6b8e3c1743b7116e69e22229516" "3ff1caa1681fac09120eca307586e1a7");
+        const auto ks = aes.make_key_schedule(sp800_key);
+        const block iv = to_block("000102030405060708090a0b0c0d0e0f");
+        auto data = sp800_plain;
+
+        // in two calls, to check the IV is carried over
+        block chain = iv;
+        bool ok = ks && aes.cbc_encrypt(*ks, chain, nonstd::span<uint8_t>(data).first(32));
+        ok = ok && aes.cbc_encrypt(*ks, chain, nonstd::span<uint8_t>(data).subspan(32));
+        ok = ok && expect("cbc encrypt", data, cipher);
+        chain = iv;
+        return ok && aes.cbc_decrypt(*ks, chain, data) && expect("cbc decrypt", data, sp800_plain);
+    }
+
+    bool ctr() {
+        const auto cipher = hex("874d6191b620e3261bef6864990db6ce" "9806f66b7970fdff8617187bb9fffdff"
+                                "5ae4df3edbd5d35e5b4f09020db03eab" "1e031dda2fbe03d1792170a0f3009cee");
+        const auto ks = aes.make_key_schedule(sp800_key);
+        const block counter = to_block("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+        auto data = sp800_plain;
+        block c = counter;
+        bool ok = ks && aes.ctr_crypt(*ks, c, data) && expect("ctr encrypt", data, cipher);
+
+        // a partial last block uses the start of the keystream block
+        std::vector<uint8_t> partial(sp800_plain.begin(), sp800_plain.begin() + 21);
+        c = counter;
+        ok = ok && aes.ctr_crypt(*ks, c, partial) && expect("ctr partial", partial, { cipher.begin(), cipher.begin() + 21 });
+        c = counter;
+        return ok && aes.ctr_crypt(*ks, c, data) && expect("ctr decrypt", data, sp800_plain);
+    }
+
+    /// a span longer than a 16-bit counter reaches, which used to wrap the block loop forever
+    bool long_span() {
+        const auto ks = aes.make_key_schedule(sp800_key);
+        if(!ks) { return false; }
+        std::vector<uint8_t> data(70'000, 0x5A);
+        block c{};
+        const auto encrypted = aes.ctr_crypt(*ks, c, data);
+        c = {};
+        const auto decrypted = aes.ctr_crypt(*ks, c, data);
+        return encrypted && *encrypted == data.size() && decrypted
+            && expect("long span", data, std::vector<uint8_t>(70'000, 0x5A));
+    }
+
+}   // namespace
+
+int main() {
+    bool ok = true;
+    ok = fips197() && ok;
+    ok = ecb() && ok;
+    ok = cbc() && ok;
+    ok = ctr() && ok;
+    ok = long_span() && ok;
+    std::printf("aes: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
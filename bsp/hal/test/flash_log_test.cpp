@@ -0,0 +1,199 @@
+// Check of Flash_Log on the simulated flash of NVM_Basic. Records are appended until the log has wrapped
+// several times, and every readout has to give back the newest records in order: the pages in flash with
+// consecutive sequence numbers, then the records still in RAM under sequence number 0. start() on a new
+// object has to carry on after the newest page. Then the write of a page is cut short at every word, which
+// leaves it erased with only the first part written: start() has to skip it and the log keep working.
+#include "drivers/flash_log.hpp"
+#include "sim_memory.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    constexpr uint16_t PAGES = 4;
+    constexpr uint16_t FIRST_PAGE = drivers::NVM::APP_PAGES - PAGES;
+    constexpr uint16_t PAGE_SIZE = drivers::NVM::FLASH_PAGE_SIZE;
+    constexpr uint8_t TAG = 0xF1;
+    using log_t = drivers::Flash_Log<decltype(device::NVM), FIRST_PAGE, PAGES>;
+
+    using bytes = std::vector<uint8_t>;
+    /// the same instantiation as the log, so it sees the same simulated flash
+    constexpr drivers::NVM_Basic<decltype(device::NVM)> nvm(device::NVM);
+
+    /// a readout, frame by frame
+    struct frame_sink {
+        std::vector<bytes> frames;
+        void begin() { frames.emplace_back(); }
+        void write(const uint8_t b) { frames.back().push_back(b); }
+        void write(const nonstd::span<const uint8_t> s) { frames.back().insert(frames.back().end(), s.begin(), s.end()); }
+        void end() {}
+    };
+
+    /// record n, 2 to 13 bytes starting with n
+    bytes record(const uint16_t n) {
+        bytes r(2U + n % 12U);
+        for(size_t i = 0; i < r.size(); ++i) { r[i] = static_cast<uint8_t>(n * 7U + i); }
+        r[0] = static_cast<uint8_t>(n);
+        r[1] = static_cast<uint8_t>(n >> 8U);
+        return r;
+    }
+
+    bytes snapshot() {
+        bytes image(PAGES * PAGE_SIZE);
+        nvm.flash_read(static_cast<uint32_t>(FIRST_PAGE) * PAGE_SIZE, image);
+        return image;
+    }
+
+    /// erase a page and write the first size bytes of data to it, as a write cut short would
+    void write_page(const uint16_t page, const uint8_t* data, const uint16_t size) {
+        nvm.flash_flush_buffer();
+        const bool ok = nvm.flash_load(0, { data, size }) && nvm.start_flash_erase_write(FIRST_PAGE + page, drivers::NVM::SPM_INT_LVL::OFF);
+        if(!ok) { std::printf("flash log: writing page %u failed\n", page); }
+        nvm.wait();
+    }
+
+    void restore(const bytes& image) {
+        for(uint16_t page = 0; page < PAGES; ++page) { write_page(page, &image[page * PAGE_SIZE], PAGE_SIZE); }
+    }
+
+    /**
+     * The records a readout has to give: the newest of the records in flash, flushed of them in total,
+     * then the pending ones in RAM.
+     * @param pages [IN] flash pages the readout has to send
+     */
+    bool check(const log_t& log, const std::vector<bytes>& model, const size_t flushed, const uint16_t pages, const char* what) {
+        frame_sink sink;
+        const uint16_t sent = log.readout(sink, TAG);
+        const bool ram = log.pending() != 0;
+        if(sent != sink.frames.size() || sent != pages + (ram ? 1U : 0U)) {
+            std::printf("%s: %u frames, expected %u pages%s\n", what, sent, pages, ram ? " and the RAM records" : "");
+            return false;
+        }
+        std::vector<bytes> records;
+        for(uint16_t f = 0; f < sent; ++f) {
+            const bytes& frame = sink.frames[f];
+            const uint32_t sequence = frame[1] | (frame[2] << 8U) | (frame[3] << 16U) | (static_cast<uint32_t>(frame[4]) << 24U);
+            const uint32_t expected = (f < pages) ? log.sequence() - (pages - 1U - f) : 0U;
+            if(frame[0] != TAG || sequence != expected) {
+                std::printf("%s: frame %u has sequence %u, expected %u\n", what, f, sequence, expected);
+                return false;
+            }
+            for(size_t pos = 5; pos < frame.size(); pos += 1U + frame[pos]) {
+                records.emplace_back(frame.begin() + pos + 1, frame.begin() + pos + 1 + frame[pos]);
+            }
+        }
+        // the records in flash are the newest flushed ones, followed by the pending ones
+        const size_t pending = model.size() - flushed;
+        const size_t in_flash = (records.size() >= pending) ? records.size() - pending : flushed + 1U;
+        bool ok = in_flash <= flushed;
+        for(size_t i = 0; ok && i < records.size(); ++i) {
+            const size_t n = (i < in_flash) ? flushed - in_flash + i : flushed + (i - in_flash);
+            ok = records[i] == model[n];
+        }
+        if(!ok) { std::printf("%s: the records read out are not the newest ones\n", what); }
+        return ok;
+    }
+
+    /// append records until a page has been written, returns the number of records flushed
+    size_t fill_page(log_t& log, std::vector<bytes>& model) {
+        const uint32_t sequence = log.sequence();
+        while(log.sequence() == sequence) {
+            model.push_back(record(static_cast<uint16_t>(model.size())));
+            if(!log.append(model.back())) { return 0; }
+            nvm.wait();
+        }
+        return model.size() - 1U;
+    }
+
+    bool wraparound_and_restart() {
+        log_t log(device::NVM);
+        if(!log.clear()) { return false; }
+        log.start();
+        std::vector<bytes> model;
+        size_t flushed = 0;
+        bool ok = log.sequence() == 0 && check(log, model, flushed, 0, "empty log");
+
+        // fill the log several times over, and read it out on the way
+        for(uint16_t page = 1; ok && page <= 3U * PAGES; ++page) {
+            flushed = fill_page(log, model);
+            ok = flushed > 0 && log.sequence() == page
+              && check(log, model, flushed, (page < PAGES) ? page : PAGES, "append");
+        }
+
+        // a new object finds the newest page, the records in RAM are lost
+        log_t again(device::NVM);
+        again.start();
+        model.resize(flushed);
+        ok = ok && again.sequence() == log.sequence() && again.pending() == 0
+          && check(again, model, flushed, PAGES, "restart");
+        flushed = fill_page(again, model);
+        ok = ok && flushed > 0 && again.sequence() == log.sequence() + 1U
+          && check(again, model, flushed, PAGES, "append after restart");
+        return ok;
+    }
+
+    bool torn_pages() {
+        log_t log(device::NVM);
+        if(!log.clear()) { return false; }
+        log.start();
+        std::vector<bytes> model;
+        for(uint16_t page = 0; page < 2U * PAGES + 1U; ++page) { fill_page(log, model); }
+        if(!log.flush()) { return false; }
+        nvm.wait();
+        const size_t flushed = model.size();
+        const uint32_t sequence = log.sequence();
+        const auto before = snapshot();
+
+        // the next page, written in full, and where it went
+        std::vector<bytes> more = model;
+        const size_t flushed_more = fill_page(log, more);
+        const auto after = snapshot();
+        int page = -1;
+        for(uint16_t p = 0; p < PAGES; ++p) {
+            if(!std::equal(&before[p * PAGE_SIZE], &before[(p + 1U) * PAGE_SIZE], &after[p * PAGE_SIZE])) { page = p; }
+        }
+        if(flushed_more == 0 || page < 0) {
+            std::printf("torn page: the page write was not found\n");
+            return false;
+        }
+
+        // the page is complete once everything up to its last record is written
+        const uint8_t* written = &after[page * PAGE_SIZE];
+        uint16_t used = PAGE_SIZE;
+        while(used > 0 && written[used - 1U] == 0xFF) { --used; }
+        uint32_t cuts = 0;
+        for(uint16_t cut = 0; cut <= PAGE_SIZE; cut += 2) {
+            restore(before);
+            write_page(static_cast<uint16_t>(page), written, cut);
+            const bool complete = cut >= used;
+            log_t recovered(device::NVM);
+            recovered.start();
+            std::vector<bytes> m = more;
+            m.resize(complete ? flushed_more : flushed);
+            // the torn page took the place of the oldest one, so one page fewer is left
+            bool ok = recovered.sequence() == sequence + (complete ? 1U : 0U)
+                   && check(recovered, m, m.size(), complete ? PAGES : PAGES - 1U, "torn page");
+            const size_t next = fill_page(recovered, m);
+            ok = ok && next > 0 && recovered.sequence() == sequence + (complete ? 2U : 1U)
+              && check(recovered, m, next, PAGES, "append after a torn page");
+            if(!ok) {
+                std::printf("torn page: cut at %u of %u bytes\n", cut, used);
+                return false;
+            }
+            ++cuts;
+        }
+        std::printf("flash log: %u cut page writes\n", cuts);
+        return cuts > 0;
+    }
+
+}   // namespace
+
+int main() {
+    bool ok = true;
+    ok = wraparound_and_restart() && ok;
+    ok = torn_pages() && ok;
+    std::printf("flash log: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+// Host timing of nonstd::spsc_ring operations, to compare changes to the ring against each other.
+// The numbers are for the host CPU, not the AVR, and only mean something relative to one another.
+#include "nonstd/ring.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+    constexpr uint32_t ROUNDS = 2'000'000;
+
+    /// time fn over ROUNDS rounds of elements each and print the cost per element
+    template <typename FN>
+    void bench(const char* name, const size_t elements, FN&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < ROUNDS; ++i) { fn(); }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("%-34s %6.2f ns/element\n", name, elapsed.count() / (static_cast<double>(ROUNDS) * elements));
+    }
+
+    template <size_t N>
+    void run(const char* title) {
+        static nonstd::byte_ring<N> ring;
+        std::array<uint8_t, 32> block{};
+        volatile uint8_t sink = 0;
+        std::printf("%s\n", title);
+
+        bench("push + pop", 1, [&] {
+            uint8_t c = 0;
+            ring.push(static_cast<uint8_t>(sink));
+            ring.pop(c);
+            sink = c;
+        });
+        bench("push + pop, 32 bytes", 32, [&] {
+            ring.push(nonstd::span<const uint8_t>(block.data(), block.size()));
+            ring.pop(nonstd::span<uint8_t>(block.data(), block.size()));
+            sink = block[0];
+        });
+        bench("reserve + commit, peek + consume", 1, [&] {
+            const auto space = ring.reserve();
+            space[0] = sink;
+            ring.commit(1);
+            sink = ring.peek()[0];
+            ring.consume(1);
+        });
+    }
+
+}   // namespace
+
+int main() {
+    run<64>("byte_ring<64>, 8-bit indices");
+    run<256>("byte_ring<256>, 16-bit indices");
+    return 0;
+}
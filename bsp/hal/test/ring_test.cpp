@@ -0,0 +1,213 @@
+// Lock freedom check of nonstd::spsc_ring and nonstd::spsc_message_queue with an emulated ISR.
+// A POSIX interval timer signal runs the ISR side on the main thread, interrupting it at any instruction,
+// like an interrupt on the AVR. The ISR can't wait for the main loop it interrupted, so if either side ever
+// blocked on the other this would hang, and a torn index or a reordered access shows up as data out of order.
+#include "nonstd/ring.hpp"
+#include <array>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <sys/time.h>
+
+namespace {
+
+    static_assert(sizeof(nonstd::ring::index_t<64>) == 1, "64 elements take 8-bit indices");
+    static_assert(sizeof(nonstd::ring::index_t<256>) == 2, "256 elements take 16-bit indices");
+
+    /// run isr every few microseconds until stop()
+    void start(void (*isr)(int)) {
+        struct sigaction action{};
+        action.sa_handler = isr;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGALRM, &action, nullptr);
+
+        itimerval timer{};
+        timer.it_interval.tv_usec = 10;
+        timer.it_value.tv_usec = 10;
+        setitimer(ITIMER_REAL, &timer, nullptr);
+    }
+
+    void stop() {
+        itimerval timer{};
+        setitimer(ITIMER_REAL, &timer, nullptr);
+        signal(SIGALRM, SIG_IGN);
+    }
+
+    constexpr uint32_t COUNT = 200'000;
+
+    /// the ISR produces and the main loop consumes, like a receive interrupt
+    template <size_t N>
+    struct rx_test {
+        static inline nonstd::spsc_ring<uint16_t, N> ring;
+        static inline volatile uint16_t produced = 0;
+        static inline volatile uint32_t calls = 0;
+
+        static void isr(int) {
+            ++calls;
+            switch(calls % 3U) {
+                case 0:
+                    // a burst, so the ring also runs full
+                    for(uint8_t i = 0; i < 7U && ring.push(static_cast<uint16_t>(produced)); ++i) { produced = produced + 1U; }
+                    break;
+                case 1: {
+                    std::array<uint16_t, 5> batch{};
+                    for(uint8_t i = 0; i < batch.size(); ++i) { batch[i] = static_cast<uint16_t>(produced + i); }
+                    produced = static_cast<uint16_t>(produced + ring.push(nonstd::span<const uint16_t>(batch.data(), batch.size())));
+                    break;
+                }
+                default: {
+                    const auto space = ring.reserve();
+                    const size_t count = (space.size() < 3U) ? space.size() : 3U;
+                    for(size_t i = 0; i < count; ++i) { space[i] = static_cast<uint16_t>(produced + i); }
+                    ring.commit(count);
+                    produced = static_cast<uint16_t>(produced + count);
+                    break;
+                }
+            }
+        }
+
+        static bool run() {
+            start(isr);
+            uint16_t expect = 0;
+            std::array<uint16_t, 4> batch{};
+            for(uint32_t taken = 0; taken < COUNT;) {
+                size_t count = 0;
+                switch(taken % 3U) {
+                    case 0:
+                        count = ring.pop(batch[0]) ? 1U : 0U;
+                        break;
+                    case 1:
+                        count = ring.pop(nonstd::span<uint16_t>(batch.data(), batch.size()));
+                        break;
+                    default: {
+                        const auto filled = ring.peek();
+                        count = (filled.size() < batch.size()) ? filled.size() : batch.size();
+                        for(size_t i = 0; i < count; ++i) { batch[i] = filled[i]; }
+                        ring.consume(count);
+                        break;
+                    }
+                }
+                for(size_t i = 0; i < count; ++i, ++expect) {
+                    if(batch[i] != expect) {
+                        stop();
+                        std::printf("rx<%zu>: expected %u, got %u\n", N, expect, batch[i]);
+                        return false;
+                    }
+                }
+                taken += count;
+            }
+            stop();
+            std::printf("rx<%zu>: %u elements, %u interrupts\n", N, COUNT, calls);
+            return true;
+        }
+    };
+
+    /// the main loop produces and the ISR consumes, like a transmit interrupt
+    template <size_t N>
+    struct tx_test {
+        static inline nonstd::spsc_ring<uint16_t, N> ring;
+        static inline volatile uint16_t consumed = 0;
+        static inline volatile uint32_t calls = 0;
+        static inline volatile bool failed = false;
+
+        static bool check(const uint16_t v) {
+            if(v != consumed) { failed = true; }
+            consumed = consumed + 1U;
+            return !failed;
+        }
+
+        static void isr(int) {
+            ++calls;
+            if(calls % 2U) {
+                uint16_t v = 0;
+                for(uint8_t i = 0; i < 6U && ring.pop(v) && check(v); ++i) {}
+            }
+            else {
+                std::array<uint16_t, 6> batch{};
+                const size_t count = ring.pop(nonstd::span<uint16_t>(batch.data(), batch.size()));
+                for(size_t i = 0; i < count && check(batch[i]); ++i) {}
+            }
+        }
+
+        static bool run() {
+            start(isr);
+            uint16_t next = 0;
+            for(uint32_t put = 0; put < COUNT && !failed;) {
+                if(put % 2U) {
+                    put += ring.push(next) ? 1U : 0U;
+                }
+                else {
+                    const std::array<uint16_t, 3> batch{ next, static_cast<uint16_t>(next + 1U), static_cast<uint16_t>(next + 2U) };
+                    put += ring.push_all(nonstd::span<const uint16_t>(batch.data(), batch.size())) ? 3U : 0U;
+                }
+                next = static_cast<uint16_t>(put);
+            }
+            while(!ring.empty() && !failed) {}
+            stop();
+            if(failed) {
+                std::printf("tx<%zu>: out of order at %u\n", N, consumed);
+                return false;
+            }
+            std::printf("tx<%zu>: %u elements, %u interrupts\n", N, COUNT, calls);
+            return true;
+        }
+    };
+
+    /// the ISR sends messages of 1-19 bytes, each filled with its sequence number
+    struct message_test {
+        static inline nonstd::spsc_message_queue<256> queue;
+        static inline volatile uint8_t sent = 0;
+        static inline volatile uint32_t calls = 0;
+
+        static void isr(int) {
+            ++calls;
+            std::array<uint8_t, 19> message{};
+            const uint8_t seq = sent;
+            message.fill(seq);
+            if(queue.send({ message.data(), static_cast<size_t>(seq % 19U + 1U) })) { sent = seq + 1U; }
+        }
+
+        static bool run() {
+            if(queue.send({})) {
+                std::printf("messages: an empty message was queued\n");
+                return false;
+            }
+            start(isr);
+            uint8_t expect = 0;
+            std::array<uint8_t, 32> message{};
+            for(uint32_t received = 0; received < COUNT / 10U;) {
+                if(queue.empty()) { continue; }
+                const size_t length = queue.receive(message);
+                if(length != expect % 19U + 1U) {
+                    stop();
+                    std::printf("messages: %u has length %zu\n", expect, length);
+                    return false;
+                }
+                for(size_t i = 0; i < length; ++i) {
+                    if(message[i] != expect) {
+                        stop();
+                        std::printf("messages: %u has byte %u\n", expect, message[i]);
+                        return false;
+                    }
+                }
+                ++expect;
+                ++received;
+            }
+            stop();
+            std::printf("messages: %u messages, %u interrupts\n", COUNT / 10U, calls);
+            return true;
+        }
+    };
+
+}   // namespace
+
+int main() {
+    bool ok = true;
+    ok = rx_test<64>::run() && ok;
+    ok = rx_test<256>::run() && ok;
+    ok = tx_test<64>::run() && ok;
+    ok = tx_test<256>::run() && ok;
+    ok = message_test::run() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+#include "sim_memory.hpp"
+#include "register.hpp"
+
+sim_memory::memory& sim_memory::data() noexcept {
+    static memory s_memory{};
+    return s_memory;
+}
+
+void sim_memory::fill(const uint8_t value) noexcept {
+    data().fill(value);
+}
+
+void* ucpp::registers::sim::get_mem_address(const uint32_t addr) noexcept {
+    return &sim_memory::data()[addr & 0xFFFFU];
+}
+
+// multi-byte registers are little endian, like the XMEGA
+template<typename T>
+T ucpp::registers::sim::read(const uint32_t addr) noexcept {
+    T value = 0;
+    for(uint32_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(sim_memory::data()[(addr + i) & 0xFFFFU] << (8U * i));
+    }
+    return value;
+}
+
+template<typename T>
+void ucpp::registers::sim::write(const uint32_t addr, const T val) noexcept {
+    for(uint32_t i = 0; i < sizeof(T); ++i) {
+        sim_memory::data()[(addr + i) & 0xFFFFU] = static_cast<uint8_t>(val >> (8U * i));
+    }
+}
+
+template void ucpp::registers::sim::write<uint8_t>(const uint32_t addr, const uint8_t val) noexcept;
+template uint8_t ucpp::registers::sim::read<uint8_t>(const uint32_t addr) noexcept;
+template void ucpp::registers::sim::write<uint16_t>(const uint32_t addr, const uint16_t val) noexcept;
+template uint16_t ucpp::registers::sim::read<uint16_t>(const uint32_t addr) noexcept;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Register and memory backend for the host checks. Replaces register.cpp, which maps a file and logs every
+// access: here the 64K data space is a plain array, so a check can set up or corrupt memory directly and
+// start each run from a known state.
+namespace sim_memory {
+
+    using memory = std::array<uint8_t, 0x10000>;
+
+    /// the whole data space, registers and memory mapped EEPROM included
+    memory& data() noexcept;
+
+    /// fill the data space with value, 0xFF for erased EEPROM
+    void fill(uint8_t value) noexcept;
+
+}   // namespace sim_memory
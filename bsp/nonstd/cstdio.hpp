@@ -2,12 +2,246 @@
 
 #include "stdio.h"
 #include "drivers/flash.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <type_traits>
+#include <utility>
 
 using namespace flash::flash_literals;
 
+/// character output provided by the board, also used by the printf library
+extern "C" void _putchar(char character);
+
 namespace nonstd {
 
+    /**
+     * Compile time formatting for flash string literals. The format string is parsed while compiling, the
+     * arguments are checked against the conversions, and each call site becomes a short list of calls to the
+     * output functions below. Nothing is parsed at runtime and vfprintf is not linked unless some other
+     * code uses it.
+     *
+     * Supported: %d %i %u %x %X %c %s %S %% with the '-' and '0' flags and a width for numbers.
+     * Length modifiers (h, hh, l) are accepted and ignored, the argument type decides the size, up to 32 bits.
+     * %u %x %X print a negative argument as its two's complement at the size of the argument, like printf.
+     * %S prints a string in flash, like avr-libc's printf_P.
+     */
+    namespace format {
+
+        enum class kind : uint8_t { LITERAL, SIGNED, UNSIGNED, HEX, HEX_UPPER, CHAR, STRING, FLASH_STRING, INVALID };
+
+        struct spec {
+            kind type = kind::LITERAL;
+            uint8_t begin = 0;      // literal: offset of the text in the format string
+            uint8_t length = 0;     // literal: number of characters
+            uint8_t arg = 0;        // conversion: index of the argument
+            uint8_t width = 0;
+            bool zero_pad = false;
+            bool left = false;
+        };
+
+        template <size_t N>
+        struct parsed {
+            static_assert(N < 256, "Format strings are limited to 255 characters, split longer ones");
+            std::array<spec, N + 1> specs{};
+            uint8_t count = 0;
+            uint8_t args = 0;
+        };
+
+        constexpr kind conversion(const char c) noexcept {
+            switch(c) {
+                case 'd':
+                case 'i': return kind::SIGNED;
+                case 'u': return kind::UNSIGNED;
+                case 'x': return kind::HEX;
+                case 'X': return kind::HEX_UPPER;
+                case 'c': return kind::CHAR;
+                case 's': return kind::STRING;
+                case 'S': return kind::FLASH_STRING;
+                default : return kind::INVALID;
+            }
+        }
+
+        /// split a format string into literal runs and conversions
+        template <size_t N>
+        constexpr parsed<N> parse(const std::array<char, N>& fmt) noexcept {
+            parsed<N> p{};
+            size_t i = 0;
+            while(i < N) {
+                spec s{};
+                if(fmt[i] != '%') {
+                    s.begin = i;
+                    while(i < N && fmt[i] != '%') { ++i; }
+                    s.length = i - s.begin;
+                }
+                else if(i + 1 < N && fmt[i + 1] == '%') {
+                    s.begin = i + 1;
+                    s.length = 1;
+                    i += 2;
+                }
+                else {
+                    ++i;
+                    for(; i < N && (fmt[i] == '-' || fmt[i] == '0'); ++i) {
+                        s.left |= fmt[i] == '-';
+                        s.zero_pad |= fmt[i] == '0';
+                    }
+                    for(; i < N && fmt[i] >= '0' && fmt[i] <= '9'; ++i) {
+                        s.width = s.width * 10 + (fmt[i] - '0');
+                    }
+                    for(; i < N && (fmt[i] == 'h' || fmt[i] == 'l'); ++i) {}
+                    s.type = (i < N) ? conversion(fmt[i]) : kind::INVALID;
+                    s.arg = p.args++;
+                    ++i;
+                }
+                // merge neighbouring literals, like the text on either side of a %%
+                if(s.type == kind::LITERAL && p.count > 0 && p.specs[p.count - 1].type == kind::LITERAL
+                   && p.specs[p.count - 1].begin + p.specs[p.count - 1].length == s.begin) {
+                    p.specs[p.count - 1].length += s.length;
+                }
+                else {
+                    p.specs[p.count++] = s;
+                }
+            }
+            return p;
+        }
+
+        /// the I-th argument
+        template <size_t I, typename T, typename... Ts>
+        constexpr const auto& get(const T& t, const Ts&... ts) noexcept {
+            if constexpr (I == 0) { return t; }
+            else { return get<I - 1>(ts...); }
+        }
+
+        template <typename T, typename = void>
+        struct is_flash : std::false_type {};
+        template <typename T>
+        struct is_flash<T, std::enable_if_t<T::in_flash>> : std::true_type {};
+
+        /******************************** output, shared by all call sites ********************************/
+
+        inline uint8_t put_flash(const char* p, const uint8_t length) noexcept {
+            for(uint8_t i = 0; i < length; ++i) {
+                _putchar(flash::read(p + i));
+            }
+            return length;
+        }
+
+        inline uint8_t put_flash(const char* p) noexcept {
+            uint8_t n = 0;
+            for(char c = flash::read(p); c != '\0'; c = flash::read(++p), ++n) {
+                _putchar(c);
+            }
+            return n;
+        }
+
+        inline uint8_t put(const char* s) noexcept {
+            uint8_t n = 0;
+            for(; *s != '\0'; ++s, ++n) {
+                _putchar(*s);
+            }
+            return n;
+        }
+
+        /// unsigned integer in base 10 or 16, optionally padded. Used with uint16_t and uint32_t only.
+        template <typename U>
+        uint8_t put_number(U value, const bool negative, const spec s) noexcept {
+            const uint8_t base = (s.type == kind::HEX || s.type == kind::HEX_UPPER) ? 16 : 10;
+            const char alpha = (s.type == kind::HEX_UPPER) ? 'A' : 'a';
+            std::array<char, 10> digits;
+            uint8_t n = 0;
+            do {
+                const uint8_t d = value % base;
+                digits[n++] = static_cast<char>(d < 10 ? '0' + d : alpha + d - 10);
+                value /= base;
+            } while(value != 0);
+
+            const uint8_t length = n + negative;
+            uint8_t pad = (s.width > length) ? s.width - length : 0;
+            const uint8_t total = length + pad;
+            if(negative && s.zero_pad) { _putchar('-'); }
+            for(; !s.left && pad > 0; --pad) { _putchar(s.zero_pad ? '0' : ' '); }
+            if(negative && !s.zero_pad) { _putchar('-'); }
+            while(n > 0) { _putchar(digits[--n]); }
+            for(; pad > 0; --pad) { _putchar(' '); }
+            return total;
+        }
+
+        /// check an argument against its conversion and print it
+        template <kind K, uint8_t WIDTH, typename T>
+        uint8_t put_arg(const T& value, const spec s) noexcept {
+            using U = std::decay_t<T>;
+            static_assert(K != kind::INVALID, "unsupported conversion in format string");
+            if constexpr (K == kind::SIGNED || K == kind::UNSIGNED || K == kind::HEX || K == kind::HEX_UPPER) {
+                static_assert(std::is_integral_v<U> || std::is_enum_v<U>, "%d %i %u %x %X need an integer argument");
+                using V = typename std::conditional_t<std::is_enum_v<U>, std::underlying_type<U>, std::common_type<U>>::type;
+                static_assert(sizeof(V) <= 4, "integers wider than 32 bits are not supported");
+                using W = std::conditional_t<(sizeof(V) > 2), uint32_t, uint16_t>;
+                const auto v = static_cast<V>(value);
+                // like printf, %u %x %X print a negative argument as its two's complement
+                if constexpr (K == kind::SIGNED && std::is_signed_v<V>) {
+                    if(v < 0) {
+                        return put_number<W>(static_cast<W>(0U - static_cast<W>(v)), true, s);
+                    }
+                }
+                return put_number<W>(static_cast<W>(v), false, s);
+            }
+            else if constexpr (K == kind::CHAR) {
+                static_assert(std::is_integral_v<U>, "%c needs a character argument");
+                static_assert(WIDTH == 0, "width is only supported for numbers");
+                _putchar(static_cast<char>(value));
+                return 1;
+            }
+            else if constexpr (K == kind::STRING) {
+                static_assert(!is_flash<U>::value, "use %S for strings in flash");
+                static_assert(std::is_convertible_v<U, const char*>, "%s needs a string argument");
+                static_assert(WIDTH == 0, "width is only supported for numbers");
+                return put(value);
+            }
+            else if constexpr (K == kind::FLASH_STRING) {
+                static_assert(is_flash<U>::value || std::is_convertible_v<U, const char*>, "%S needs a string in flash");
+                static_assert(WIDTH == 0, "width is only supported for numbers");
+                return put_flash(static_cast<const char*>(value));
+            }
+            else {
+                return 0;
+            }
+        }
+
+        /// the parsed form of a flash_string, only used in constant expressions
+        template <typename FMT>
+        inline constexpr auto parsed_v = parse(FMT::chars);
+
+        /// print one literal run or conversion of a format string
+        template <typename FMT, size_t I, typename... Args>
+        uint8_t put_segment(const Args&... args) noexcept {
+            constexpr spec s = parsed_v<FMT>.specs[I];
+            if constexpr (s.type == kind::LITERAL) {
+                return put_flash(FMT::value + s.begin, s.length);
+            }
+            else {
+                return put_arg<s.type, s.width>(get<s.arg>(args...), s);
+            }
+        }
+
+        template <typename FMT, size_t... Is, typename... Args>
+        int print(std::index_sequence<Is...>, const Args&... args) noexcept {
+            return (0 + ... + put_segment<FMT, Is>(args...));
+        }
+
+    }   // namespace format
+
+    /**
+     * Print a flash string literal, formatted at compile time.
+     * example: nonstd::print("count: %u\n"_fstr, count);
+     */
+    template<char... C, typename... Args>
+    int print(flash::flash_string<C...>, const Args&... args) {
+        using FMT = flash::flash_string<C...>;
+        constexpr auto p = format::parsed_v<FMT>;
+        static_assert(p.args == sizeof...(Args), "number of arguments doesn't match the format string");
+        return format::print<FMT>(std::make_index_sequence<p.count>{}, args...);
+    }
+
     template<typename T, typename... Args>
     std::enable_if_t<T::in_flash, int> print(T fmt, const Args&... args) {
         static_assert(T::in_flash, "format string must be a string in flash!");
@@ -21,4 +255,4 @@ namespace nonstd {
         return printf(fmt, args...);
     }
 #endif
-}
\ No newline at end of file
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "nonstd/bitpack.hpp"       // bit level packing of the differences
+#include "nonstd/expected.hpp"      // std::expected implementation for safe return value
+#include "nonstd/serialize.hpp"     // zigzag
+#include "nonstd/span.hpp"          // span for sample batches and packed blocks
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "peripheral_types.hpp"
+
+// Lossless compression of three axis sample streams, integer only and in bounded RAM. Samples are gathered
+// into blocks; a block stores its first sample as it is and every following one as the difference from the
+// sample before, each axis packed at the fewest bits that hold its largest difference in the block. Slowly
+// changing accelerometer readings pack to 4-6 bits per axis instead of 16.
+//
+// A block is:
+//   count           1 byte, 1 to 255 samples
+//   first sample    x, y, z as 16-bit little endian
+//   widths          16-bit little endian, x | y << 5 | z << 10, bits per axis 0-17
+//   differences     zigzag of x, y, z for samples 1 to count-1, packed LSB first, padded to a byte
+// Blocks stand alone, so a lost block doesn't corrupt the ones after it.
+namespace peripheral::delta_pack {
+
+    /// list of delta pack errors for external consumers.
+    /// Internal implementation (numbers) are NOT stable
+    enum class error : uint8_t {
+        TRUNCATED = (1U<<7U),
+        BAD_HEADER = (1U<<6U),
+        TOO_MANY = (1U<<5U),
+        NONE = (1U<<0U)
+    };
+
+    inline constexpr uint8_t HEADER_SIZE = 9;
+    /// the difference of two 16-bit values takes 17 bits
+    inline constexpr uint8_t MAX_WIDTH = 17;
+
+    /// most bytes a block of count samples can take
+    constexpr size_t max_block_size(const size_t count) noexcept {
+        return HEADER_SIZE + nonstd::bitpack::bytes((count - 1U) * 3U * MAX_WIDTH);
+    }
+
+    /// bytes a block of count samples takes with the given widths
+    constexpr size_t block_size(const size_t count, const uint8_t wx, const uint8_t wy, const uint8_t wz) noexcept {
+        return HEADER_SIZE + nonstd::bitpack::bytes((count - 1U) * (static_cast<size_t>(wx) + wy + wz));
+    }
+
+    inline uint32_t difference(const int16_t v, const int16_t previous) noexcept {
+        return nonstd::serialize::zigzag(static_cast<int32_t>(v) - static_cast<int32_t>(previous));
+    }
+
+    /**
+     * Streaming block encoder. Samples are added as they come, a FIFO batch at a time, and each full block
+     * is packed into the SINK, anything with write(uint8_t) like a nonstd::slip::encoder or a
+     * nonstd::serialize::buffer_writer. Only the samples of the current block are kept.
+     * example: peripheral::delta_pack::encoder<32> pack;
+     *          const auto n = accel.readFIFO(buf, count);  if(n) { pack.write(tx, nonstd::span<const Acceleration>(buf.data(), *n)); }
+     * @tparam BLOCK samples per block, larger blocks spread the header over more samples
+     */
+    template <uint8_t BLOCK = 32>
+    class encoder {
+        static_assert(BLOCK >= 2, "A block of one sample doesn't pack");
+
+        std::array<ThreeAxis, BLOCK> m_block{};
+        uint8_t m_count = 0;
+
+    public:
+        static constexpr size_t max_block_size = delta_pack::max_block_size(BLOCK);
+
+        [[nodiscard]] uint8_t size() const noexcept { return m_count; }
+        [[nodiscard]] bool empty() const noexcept { return m_count == 0; }
+
+        /// add a sample. Returns true when the block is full and has to be flushed before the next one.
+        bool add(const ThreeAxis& sample) noexcept {
+            if(m_count < BLOCK) {
+                m_block[m_count++] = sample;
+            }
+            return m_count == BLOCK;
+        }
+
+        /**
+         * Add a batch of samples, packing each block into the sink as it fills.
+         * @return the number of blocks written
+         */
+        template <typename SINK, typename T>
+        size_t write(SINK& sink, nonstd::span<const T> samples) noexcept {
+            size_t blocks = 0;
+            for(const ThreeAxis& s : samples) {
+                if(add(s)) {
+                    flush(sink);
+                    ++blocks;
+                }
+            }
+            return blocks;
+        }
+
+        /// pack the samples added so far as a block, full or not. Returns false if there were none.
+        template <typename SINK>
+        bool flush(SINK& sink) noexcept {
+            if(m_count == 0) { return false; }
+
+            uint32_t mx = 0, my = 0, mz = 0;
+            for(uint8_t i = 1; i < m_count; ++i) {
+                mx |= difference(m_block[i].x, m_block[i - 1U].x);
+                my |= difference(m_block[i].y, m_block[i - 1U].y);
+                mz |= difference(m_block[i].z, m_block[i - 1U].z);
+            }
+            // the width of the OR of the values is the width of the largest one
+            const uint8_t wx = nonstd::bitpack::width(mx);
+            const uint8_t wy = nonstd::bitpack::width(my);
+            const uint8_t wz = nonstd::bitpack::width(mz);
+            const auto widths = static_cast<uint16_t>(wx | (wy << 5U) | (wz << 10U));
+
+            const auto word = [&sink](const uint16_t v) {
+                sink.write(static_cast<uint8_t>(v));
+                sink.write(static_cast<uint8_t>(v >> 8U));
+            };
+            sink.write(m_count);
+            word(static_cast<uint16_t>(m_block[0].x));
+            word(static_cast<uint16_t>(m_block[0].y));
+            word(static_cast<uint16_t>(m_block[0].z));
+            word(widths);
+
+            nonstd::bitpack::writer bits(sink);
+            for(uint8_t i = 1; i < m_count; ++i) {
+                bits.write(difference(m_block[i].x, m_block[i - 1U].x), wx);
+                bits.write(difference(m_block[i].y, m_block[i - 1U].y), wy);
+                bits.write(difference(m_block[i].z, m_block[i - 1U].z), wz);
+            }
+            bits.flush();
+
+            m_count = 0;
+            return true;
+        }
+
+        /// drop the samples of a partly filled block
+        void clear() noexcept { m_count = 0; }
+    };
+
+    /**
+     * Unpack one block from the front of in and advance past it, so a buffer of blocks is read by calling
+     * this until in is empty.
+     * @param in [IN] packed blocks
+     * @param out [OUT] the samples
+     * @return the number of samples
+     */
+    template <typename T>
+    nonstd::expected<uint8_t, error> decode_block(nonstd::span<const uint8_t>& in, nonstd::span<T> out) noexcept {
+        if(in.size() < HEADER_SIZE) {
+            return nonstd::make_unexpected(error::TRUNCATED);
+        }
+        const uint8_t count = in[0];
+        const auto word = [&in](const size_t at) {
+            return static_cast<uint16_t>(in[at] | (in[at + 1U] << 8U));
+        };
+        const uint16_t widths = word(7);
+        const uint8_t wx = widths & 0x1FU;
+        const uint8_t wy = (widths >> 5U) & 0x1FU;
+        const uint8_t wz = (widths >> 10U) & 0x1FU;
+        if(count == 0 || wx > MAX_WIDTH || wy > MAX_WIDTH || wz > MAX_WIDTH) {
+            return nonstd::make_unexpected(error::BAD_HEADER);
+        }
+        if(count > out.size()) {
+            return nonstd::make_unexpected(error::TOO_MANY);
+        }
+        if(in.size() < block_size(count, wx, wy, wz)) {
+            return nonstd::make_unexpected(error::TRUNCATED);
+        }
+
+        out[0].x = static_cast<int16_t>(word(1));
+        out[0].y = static_cast<int16_t>(word(3));
+        out[0].z = static_cast<int16_t>(word(5));
+        in = in.subspan(HEADER_SIZE);
+
+        nonstd::bitpack::reader bits(in);
+        uint32_t dx = 0, dy = 0, dz = 0;
+        for(uint8_t i = 1; i < count; ++i) {
+            // the length was checked above, so these can't run out
+            bits.read(dx, wx);
+            bits.read(dy, wy);
+            bits.read(dz, wz);
+            // the differences were taken in 32 bits, so the sums land back in range
+            out[i].x = static_cast<int16_t>(out[i - 1U].x + nonstd::serialize::unzigzag(dx));
+            out[i].y = static_cast<int16_t>(out[i - 1U].y + nonstd::serialize::unzigzag(dy));
+            out[i].z = static_cast<int16_t>(out[i - 1U].z + nonstd::serialize::unzigzag(dz));
+        }
+        bits.align();
+        return count;
+    }
+
+}   // namespace peripheral::delta_pack
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "nonstd/serialize.hpp"     // schemas and batches
+#include "delta_pack.hpp"           // packed three axis blocks
+#include "peripheral_types.hpp"
+
+/// Wire formats of the sensor data, decoded on the host by scripts/telemetry_decode.py
+namespace peripheral::telemetry {
+
+    using nonstd::serialize::encoding;
+    using nonstd::serialize::field;
+
+    /// three axis samples as they are, 6 bytes each
+    using three_axis = nonstd::serialize::schema<1,
+        field<&ThreeAxis::x>,
+        field<&ThreeAxis::y>,
+        field<&ThreeAxis::z>>;
+
+    /// three axis samples as differences from the sample before. Slowly changing readings take 3 bytes.
+    using three_axis_delta = nonstd::serialize::schema<2,
+        field<&ThreeAxis::x, encoding::DELTA>,
+        field<&ThreeAxis::y, encoding::DELTA>,
+        field<&ThreeAxis::z, encoding::DELTA>>;
+
+    /// three axis samples in peripheral::delta_pack blocks: this id, then whole blocks. About 1.5 bytes a sample.
+    inline constexpr uint8_t three_axis_packed = nonstd::serialize::RESERVED;
+
+    /// a page of a drivers::Flash_Log readout. Each record in it is decoded like a frame of its own.
+    inline constexpr uint8_t log_page = nonstd::serialize::RESERVED + 1U;
+
+}   // namespace peripheral::telemetry
@@ -3,6 +3,11 @@
 //#include <avr/eeprom.h>
 
 [[gnu::OS_main]] int main() {
+    if(!board::init()) {
+        // no system clock, and the UARTs were never started, so there is nothing to report on
+        for(;;) {}
+    }
+
 	const bool accel_good = board::accelerometer.start();
     const bool fifo_on = board::accelerometer.startFIFO(board::acceleration::SLEEP_DURATION::D_100MS);
 
@@ -0,0 +1,255 @@
+#!/usr/bin/env python
+'''
+Decode binary telemetry from the firmware: SLIP frames with a CRC-16 trailer (nonstd/slip.hpp) carrying
+schema descriptors and record batches (nonstd/serialize.hpp), or delta packed three axis blocks
+(peripherals/delta_pack.hpp). Pages read out of a flash log (drivers/flash_log.hpp) are split into
+their records, which are decoded the same way. A log page with sequence number 0 holds records the
+firmware had not written to flash yet; a later readout sends them again in a numbered page. Records are written as CSV, one line per
+record, starting with the schema id.
+
+The firmware sends a schema's descriptor before its first batch, so nothing here has to match the C++
+schemas by hand. Batches of a schema with no descriptor yet are counted and skipped.
+'''
+
+import sys
+
+SLIP_END = 0xC0
+SLIP_ESC = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+DESCRIPTOR = 0
+THREE_AXIS_PACKED = 0xF0
+LOG_PAGE = 0xF1
+FIXED, VARINT, ZIGZAG, DELTA = range(4)
+
+
+def crc16(data, crc=0xFFFF):
+    ''' CRC-16/CCITT-FALSE, the same as nonstd::crc16 '''
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def slip_frames(stream, crc=True):
+    '''
+    Split a byte stream into frame payloads. Bad escapes and CRC failures drop the frame.
+    Yields (payload, error) where error is None or a string.
+    '''
+    frame = bytearray()
+    escape = False
+    bad = None
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        for b in chunk:
+            if b == SLIP_END:
+                if bad:
+                    yield None, bad
+                elif frame:
+                    if not crc:
+                        yield bytes(frame), None
+                    elif len(frame) < 2 or crc16(frame) != 0:
+                        yield None, 'bad crc'
+                    else:
+                        yield bytes(frame[:-2]), None
+                frame = bytearray()
+                escape = False
+                bad = None
+            elif bad:
+                continue
+            elif escape:
+                escape = False
+                if b == SLIP_ESC_END:
+                    frame.append(SLIP_END)
+                elif b == SLIP_ESC_ESC:
+                    frame.append(SLIP_ESC)
+                else:
+                    bad = 'bad escape'
+            elif b == SLIP_ESC:
+                escape = True
+            else:
+                frame.append(b)
+
+
+def get_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise ValueError('truncated varint')
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def parse_descriptor(payload):
+    ''' [0, id, count, field...], each field is encoding << 5 | signed << 4 | size '''
+    schema_id, count = payload[1], payload[2]
+    fields = [(d >> 5, bool(d & 0x10), d & 0x0F) for d in payload[3:3 + count]]
+    if len(fields) != count:
+        raise ValueError('truncated descriptor')
+    return schema_id, fields
+
+
+def parse_batch(payload, fields):
+    ''' [id, count varint, records...], DELTA fields are relative to the record before '''
+    count, pos = get_varint(payload, 1)
+    previous = [0] * len(fields)
+    records = []
+    for _ in range(count):
+        record = []
+        for i, (encoding, signed, size) in enumerate(fields):
+            if encoding == FIXED:
+                if pos + size > len(payload):
+                    raise ValueError('truncated record')
+                value = int.from_bytes(payload[pos:pos + size], 'little', signed=signed)
+                pos += size
+            else:
+                raw, pos = get_varint(payload, pos)
+                if encoding == VARINT:
+                    value = raw
+                elif encoding == ZIGZAG:
+                    value = unzigzag(raw)
+                else:
+                    value = previous[i] + unzigzag(raw)
+                    # the firmware stores the sum in the member type, so it wraps the same way
+                    bits = 8 * size
+                    value &= (1 << bits) - 1
+                    if signed and value >= 1 << (bits - 1):
+                        value -= 1 << bits
+            record.append(value)
+        previous = record
+        records.append(record)
+    return records
+
+
+def parse_packed(payload):
+    ''' [0xF0, blocks...], each block is count, first x y z, widths, then the packed differences '''
+    pos = 1
+    records = []
+    while pos < len(payload):
+        if pos + 9 > len(payload):
+            raise ValueError('truncated block')
+        count = payload[pos]
+        first = [int.from_bytes(payload[pos + 1 + 2 * i:pos + 3 + 2 * i], 'little', signed=True) for i in range(3)]
+        widths = int.from_bytes(payload[pos + 7:pos + 9], 'little')
+        widths = [(widths >> (5 * i)) & 0x1F for i in range(3)]
+        pos += 9
+        size = ((count - 1) * sum(widths) + 7) // 8
+        if count == 0 or max(widths) > 17 or pos + size > len(payload):
+            raise ValueError('bad block')
+        # LSB first, so the block's bits are one little endian number
+        bits = int.from_bytes(payload[pos:pos + size], 'little')
+        pos += size
+        records.append(first)
+        for _ in range(count - 1):
+            record = []
+            for axis, width in enumerate(widths):
+                record.append(records[-1][axis] + unzigzag(bits & ((1 << width) - 1)))
+                bits >>= width
+            records.append(record)
+    return records
+
+
+def parse_log_page(payload):
+    ''' [0xF1, sequence u32, records...], each record is a length byte and a payload. Sequence 0 is not in flash yet. '''
+    if len(payload) < 5:
+        raise ValueError('truncated log page')
+    sequence = int.from_bytes(payload[1:5], 'little')
+    pos = 5
+    records = []
+    while pos < len(payload):
+        length = payload[pos]
+        if length == 0 or pos + 1 + length > len(payload):
+            raise ValueError('bad log record')
+        records.append(payload[pos + 1:pos + 1 + length])
+        pos += 1 + length
+    return sequence, records
+
+
+class SerialStream:
+    ''' blocks for the first byte only, so frames are decoded as they arrive '''
+    def __init__(self, port):
+        self.port = port
+
+    def read(self, size):
+        return self.port.read(max(1, min(size, self.port.in_waiting)))
+
+
+def handle(payload, schemas, output, stats):
+    if payload[0] == DESCRIPTOR:
+        schema_id, fields = parse_descriptor(payload)
+        schemas[schema_id] = fields
+    elif payload[0] == LOG_PAGE:
+        sequence, records = parse_log_page(payload)
+        stats['pages'] += 1
+        if sequence == 0:
+            stats['unsaved'] += 1
+        for record in records:
+            handle(record, schemas, output, stats)
+    elif payload[0] == THREE_AXIS_PACKED:
+        for record in parse_packed(payload):
+            output.write(','.join(str(v) for v in [payload[0]] + record) + '\n')
+            stats['records'] += 1
+    elif payload[0] in schemas:
+        for record in parse_batch(payload, schemas[payload[0]]):
+            output.write(','.join(str(v) for v in [payload[0]] + record) + '\n')
+            stats['records'] += 1
+    else:
+        stats['unknown'] += 1
+
+
+def main(stream, output, crc=True):
+    schemas = {}
+    stats = {'frames': 0, 'records': 0, 'pages': 0, 'unsaved': 0, 'dropped': 0, 'unknown': 0}
+    for payload, error in slip_frames(stream, crc):
+        if error:
+            stats['dropped'] += 1
+            continue
+        stats['frames'] += 1
+        try:
+            handle(payload, schemas, output, stats)
+        except (ValueError, IndexError):
+            stats['dropped'] += 1
+    return stats
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser(
+        description = 'Decode SLIP framed binary telemetry into CSV')
+    parser.add_argument('-i', '--input', type = str, default = '-',
+                        help = 'capture file or serial port, "-" for stdin')
+    parser.add_argument('-b', '--baud', type = int, default = None,
+                        help = 'open the input as a serial port at this baud rate (needs pyserial)')
+    parser.add_argument('-o', '--output', type = argparse.FileType('w'), default = sys.stdout,
+                        help = 'CSV output, stdout by default')
+    parser.add_argument('--no-crc', action = 'store_true',
+                        help = 'frames have no CRC-16 trailer')
+
+    args = parser.parse_args()
+
+    if args.baud:
+        import serial
+        stream = SerialStream(serial.Serial(args.input, args.baud))
+    elif args.input == '-':
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, 'rb')
+
+    stats = main(stream, args.output, not args.no_crc)
+    print('[INFO] {frames} frames, {records} records, {pages} log pages ({unsaved} not in flash yet), {dropped} dropped, {unknown} of unknown schemas'.format(**stats),
+          file = sys.stderr)